@@ -0,0 +1,84 @@
+#ifndef AES_KERNELS_HPP
+#define AES_KERNELS_HPP
+
+#include "crypto_utils.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// In-tree AES kernels written with x86 AES-NI and VAES (AVX-512) intrinsics, for comparison with
+// OpenSSL's own code. They are compiled for their instruction set regardless of the build flags
+// and only entered after a runtime CPU check.
+
+// block cipher modes implemented by the kernels
+enum class AesMode {
+    CBC, // PKCS#7 padded, like the EVP CBC ciphers
+    CTR, // 128-bit big-endian counter starting at the IV, length preserving
+};
+
+// instruction set a kernel is written for
+enum class AesIsa {
+    AESNI, // one block per instruction (128-bit registers)
+    VAES,  // four blocks per instruction (512-bit registers, AVX-512F/BW)
+};
+
+std::string aesModeToString(AesMode mode);
+std::string aesIsaToString(AesIsa isa);
+
+// OpenSSL name of the EVP cipher the kernels must match, e.g. "AES-256-CTR"
+std::string aesEvpName(AesMode mode, size_t keyBytes);
+
+// true if this build has the kernels for `isa` and the CPU supports them
+bool aesIsaAvailable(AesIsa isa);
+
+// true if this build has the AES-NI kernels and the CPU supports them
+bool aesniAvailable();
+
+// true if the kernels were compiled with optimisation; at -O0 the intrinsics are not inlined and
+// the kernels are far too slow to compare with OpenSSL
+bool aesKernelsOptimised();
+
+// Same contract as encrypt_into_with_timing/decrypt_into_with_timing in crypto_utils.hpp, for
+// AES-128 or AES-256 (16 or 32 byte key) in `mode`: `out` needs room for length + 16 bytes and may
+// equal `in`; the time covers key expansion and the cipher work. CBC encryption is a serial chain,
+// so its VAES variant runs the AES-NI code. Throws std::invalid_argument for a bad key/IV size or
+// an unavailable instruction set, std::runtime_error for a CBC ciphertext with bad length or padding.
+// Returns pair<outputLength, timeMs>
+std::pair<size_t, double> aes_kernel_encrypt_into_with_timing(
+    AesIsa isa,
+    AesMode mode,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+std::pair<size_t, double> aes_kernel_decrypt_into_with_timing(
+    AesIsa isa,
+    AesMode mode,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// most messages aes128_cbc_encrypt_interleaved keeps in flight at once
+const int kMaxCbcLanes = 8;
+
+// AES-128-CBC encryption of many independent messages (each BatchItem with its own IV and PKCS#7
+// padding, output identical to encrypt(CipherType::AES, ...)). CBC encryption is a serial chain
+// within a message, so a single message leaves the AES unit waiting on each block's latency; here
+// `lanes` (1..kMaxCbcLanes) messages are encrypted together, one block of each per step, so their
+// rounds overlap in the pipeline. A lane that finishes picks up the next message.
+// Falls back to encrypt_batch when AES-NI is unavailable. Throws std::invalid_argument for a
+// key that is not 16 bytes or a lane count out of range.
+void aes128_cbc_encrypt_interleaved(
+    std::vector<BatchItem>& items,
+    const std::vector<unsigned char>& key,
+    int lanes = kMaxCbcLanes
+);
+
+#endif // AES_KERNELS_HPP
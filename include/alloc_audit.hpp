@@ -0,0 +1,32 @@
+#ifndef ALLOC_AUDIT_HPP
+#define ALLOC_AUDIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Allocation auditing: OpenSSL allocations are counted through CRYPTO_set_mem_functions hooks
+// and C++ allocations through a replaced global operator new. Counters are per thread, so
+// helper threads do not pollute a measurement, and only run while counting is enabled.
+
+// allocations seen on the calling thread since counting was last reset
+struct AllocCounters {
+    uint64_t cryptoAllocs = 0; // OpenSSL malloc/realloc calls
+    uint64_t cryptoBytes = 0;
+    uint64_t cxxAllocs = 0;    // operator new / new[] calls
+    uint64_t cxxBytes = 0;
+};
+
+// Route OpenSSL's allocator through the counting hooks. Must be called before OpenSSL
+// allocates anything (i.e. first thing in main); returns false if it was too late.
+bool installCryptoAllocHooks();
+
+// start/stop counting on all threads (off by default, so other modes pay nothing)
+void setAllocCounting(bool enabled);
+
+// zero the calling thread's counters
+void resetAllocCounters();
+
+// snapshot of the calling thread's counters
+AllocCounters allocCounters();
+
+#endif // ALLOC_AUDIT_HPP
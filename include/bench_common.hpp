@@ -0,0 +1,102 @@
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// helpers shared by the benchmark modes in bench*.cpp
+
+// simple POSIX helpers for path existence and directory creation
+bool pathExists(const std::string& p);
+void ensureDir(const std::string& dir);
+
+// open results/<name> for writing (creating the results directory if needed)
+std::ofstream openResultsFile(const std::string& name);
+
+// `value` as one CSV field: quoted (with inner quotes doubled) if it holds a comma, quote or newline
+std::string csvField(const std::string& value);
+
+// mean and (population) standard deviation of a series of samples
+std::pair<double, double> meanAndStddev(const std::vector<double>& samples);
+
+// Warm up with one call, then `iters` throughput samples (MB/s) of `reps` calls of `op`, each of
+// which processes `bytes` bytes and returns its own crypto time in ms (e.g. *_into_with_timing)
+std::pair<double, double> sampleThroughput(int iters, size_t reps, size_t bytes, const std::function<double()>& op);
+
+// sampleThroughput for an `op` that does not time itself: the wall clock runs around all `reps` calls
+std::pair<double, double> sampleWallThroughput(int iters, size_t reps, size_t bytes, const std::function<void()>& op);
+
+// One untimed pass of op(0) .. op(messages - 1), then `iters` timed passes; returns mean ns per
+// call and its stddev. The warm-up pass fills caches and anything `op` sets up lazily (a key
+// cache, say); afterWarmup, if given, runs between it and the timed passes, e.g. to reset counters.
+std::pair<double, double> nsPerMessage(int iters, size_t messages, const std::function<void(size_t)>& op,
+                                       const std::function<void()>& afterWarmup = nullptr);
+
+// IVs in the pool returned by randomIvs
+const size_t kIvPoolSize = 64;
+
+// kIvPoolSize random 16-byte IVs, for the per-message modes to cycle through (message m uses
+// ivs[m % kIvPoolSize]) so that consecutive messages never share an IV
+std::vector<std::vector<unsigned char>> randomIvs();
+
+// value at percentile p (0-100) of samples sorted in ascending order (nearest rank; 0 if empty)
+double percentile(const std::vector<double>& sorted, double p);
+
+// human readable byte count using binary units ("48K", "2M", "1.5G")
+std::string formatBytes(size_t bytes);
+
+// memory cost of one benchmark cell: peak RSS while it ran plus the page faults and context
+// switches it caused (whole process, so worker threads are included)
+struct CellResources {
+    long peakRssKb = 0;
+    long minorFaults = 0;
+    long majorFaults = 0;
+    long voluntarySwitches = 0;
+    long involuntarySwitches = 0;
+};
+
+// Measures CellResources from construction until finish(). Construction resets the kernel's
+// peak-RSS mark (/proc/self/clear_refs), so the peak covers this cell only where supported
+// (otherwise it is the peak of the whole run); counters come from getrusage(RUSAGE_SELF).
+class ResourceMeter {
+public:
+    ResourceMeter();
+    CellResources finish() const;
+
+private:
+    long minorFaults_;
+    long majorFaults_;
+    long voluntarySwitches_;
+    long involuntarySwitches_;
+};
+
+// CSV columns for CellResources (with a leading comma) and the matching values
+extern const char* const kResourceCsvHeader;
+void writeResourceCsv(std::ostream& out, const CellResources& r);
+
+// one-line console summary, e.g. "peak RSS 12.3 MB, faults 10 minor / 0 major, ctx switches 2 / 5"
+std::string formatResources(const CellResources& r);
+
+// number of CPUs this process may run on
+int availableCpus();
+
+// pin the calling thread to one CPU: cpus[cpuIndex % cpus.size()], or with an empty list
+// the cpuIndex-th CPU of the allowed set (wrapped around)
+void pinCurrentThread(int cpuIndex, const std::vector<int>& cpus = {});
+
+// CPUs of a NUMA node that this process may run on (empty for node < 0: no restriction)
+std::vector<int> cpusForNode(int node);
+
+// thread counts to benchmark: the user's list if given, else 1, 2, 4, ... up to availableCpus()
+std::vector<int> defaultThreadCounts(const std::vector<int>& requested);
+
+// Run work(threadIndex) on `threads` threads, each pinned to its own CPU (taken from `cpus`
+// if given, see pinCurrentThread). All threads are released together after they have started;
+// returns the wall time in ms from release until the last thread finishes. Exceptions thrown by
+// a worker are rethrown on the calling thread.
+double runParallel(int threads, const std::function<void(int)>& work, const std::vector<int>& cpus = {});
+
+#endif // BENCH_COMMON_HPP
@@ -0,0 +1,92 @@
+#ifndef BENCH_MODES_HPP
+#define BENCH_MODES_HPP
+
+#include "bench_options.hpp"
+
+// entry points of the benchmark modes selected with --mode (the default suite lives in bench.cpp);
+// each prints its progress, writes its own CSV under results/ and throws on failure
+
+// --mode=wss: throughput of each cipher as the working set crosses L1, L2, L3 and DRAM
+void runWorkingSetSweep(const BenchOptions& opts);
+
+// --mode=roofline: memcpy/STREAM-triad bandwidth and each cipher's throughput as a fraction of it
+void runRoofline(const BenchOptions& opts);
+
+// --mode=alignment: throughput of each cipher per page size and input/output misalignment
+void runAlignmentSweep(const BenchOptions& opts);
+
+// --mode=numa: throughput of each cipher with buffers on the threads' own versus remote NUMA nodes
+void runNumaBenchmark(const BenchOptions& opts);
+
+// --mode=stream: chunked encrypt/decrypt of an arbitrarily long generated stream in constant
+// memory, verified by comparing digests computed on a separate thread
+void runStreamVerify(const BenchOptions& opts);
+
+// --mode=alloc: OpenSSL and C++ allocations per call of every crypto_utils entry point in
+// steady state; with --strict-alloc the run fails if an allocation-free variant allocates
+void runAllocationAudit(const BenchOptions& opts);
+
+// --mode=zerofill: cost of value-initialising (zeroing) an output buffer before encrypting into
+// it, std::vector versus ByteBuffer, at 2.5 MiB, 64 MiB and 1 GiB (or the --sizes list)
+void runZeroFillCost(const BenchOptions& opts);
+
+// --mode=inplace: throughput and memory footprint of in-place versus out-of-place encryption and
+// decryption per cipher and message size (--sizes)
+void runInPlaceBenchmark(const BenchOptions& opts);
+
+// --mode=gather: encrypt_gather/decrypt_gather over scattered fragments versus concatenating them
+// first, per message size (--sizes) and fragment count (--fragments)
+void runGatherBenchmark(const BenchOptions& opts);
+
+// --mode=batch: ops/s and ns/message of encrypt_batch/decrypt_batch versus one encrypt/decrypt
+// call per message, for small messages (--sizes) in batches of --batch-size
+void runBatchBenchmark(const BenchOptions& opts);
+
+// --mode=multistream: aggregate AES-128-CBC encryption throughput of --batch-size messages
+// encrypted 1-8 at a time by the interleaved AES-NI kernel versus serial encrypt calls
+void runMultiStreamBenchmark(const BenchOptions& opts);
+
+// --mode=kernels: EVP versus the in-tree AES-NI and VAES kernels for AES-128/256 CBC and CTR,
+// each kernel verified against EVP output first
+void runKernelComparison(const BenchOptions& opts);
+
+// --mode=backends: per-call cost of each CryptoBackend (--backends) on the same CBC messages
+// (--sizes), each backend verified against the EVP backend first
+void runBackendComparison(const BenchOptions& opts);
+
+// --mode=fetch: EVP_CipherInit_ex cost with legacy (implicitly fetched) ciphers, a fetch per init
+// and the pre-fetched cipher cache, on 1 thread and under --threads
+void runFetchBenchmark(const BenchOptions& opts);
+
+// --mode=contention: aggregate throughput of short new/init/update/final/free operations (16-256 B,
+// --sizes) versus --threads, without mitigation and with per-thread OSSL_LIB_CTX, pre-fetched
+// ciphers and pooled contexts
+void runInitContention(const BenchOptions& opts);
+
+// --mode=providers: EVP throughput per cipher and size (--sizes) under the default, FIPS and
+// default+legacy provider configurations (plus --providers/--properties), each in its own library
+// context, with the delta to the first configuration that loaded
+void runProviderMatrix(const BenchOptions& opts);
+
+// --mode=libs: re-runs this binary as a worker child per libcrypto build (system plus --libcrypto
+// directories, via LD_LIBRARY_PATH) and merges their EVP throughput into one table with speedups
+// versus the system build; with --lib-worker it is the child's measurement run
+void runLibraryComparison(const BenchOptions& opts);
+
+// --mode=session: messages/s of encrypt/decrypt_into_with_timing (full cipher and key setup per
+// message) versus CipherSession::process (IV-only re-init), at 64 B to 16 KiB (--sizes)
+void runSessionBenchmark(const BenchOptions& opts);
+
+// --mode=tenants: encrypt throughput of a Zipf-distributed many-key workload (--keys, --zipf) with a
+// full init per message versus a KeyedContextCache of --key-cache pre-keyed contexts, with hit rates
+void runTenantWorkload(const BenchOptions& opts);
+
+// --mode=replay: replays the --trace messages (--pacing=full or recorded), with throughput and
+// per-message latency percentiles overall and per cipher and direction
+void runTraceReplay(const BenchOptions& opts);
+
+// --mode=imix: packets/s and weighted MB/s of shuffled packet streams drawn from built-in size
+// mixes (--mixes) and a --mix of the user's, per cipher, with a breakdown per packet size
+void runPacketMix(const BenchOptions& opts);
+
+#endif // BENCH_MODES_HPP
@@ -0,0 +1,109 @@
+#ifndef BENCH_OPTIONS_HPP
+#define BENCH_OPTIONS_HPP
+
+#include "crypto_backend.hpp"
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// which benchmark to run (--mode=...)
+enum class BenchMode {
+    SUITE,       // per-file encrypt/decrypt timings (default)
+    WSS,         // working-set-size sweep across the cache hierarchy
+    ROOFLINE,    // memory bandwidth baseline and cipher throughput relative to it
+    ALIGNMENT,   // page size and buffer misalignment sweep
+    NUMA,        // local versus remote NUMA node buffer placement
+    STREAM,      // constant-memory streaming encrypt/decrypt with digest verification
+    ALLOC,       // allocations per operation of every crypto_utils entry point
+    ZEROFILL,    // cost of zero-filling output buffers before encrypting into them
+    INPLACE,     // in-place versus out-of-place encryption and decryption
+    GATHER,      // scatter/gather encryption versus copy-then-encrypt
+    BATCH,       // batched small-message encryption versus one call per message
+    MULTISTREAM, // interleaved multi-message AES-CBC encryption versus serial calls
+    KERNELS,     // EVP versus the in-tree AES-NI/VAES kernels
+    BACKENDS,    // the same CBC workload through each CryptoBackend
+    FETCH,       // cipher init cost with implicit versus explicitly pre-fetched ciphers
+    CONTENTION,  // throughput of short operations as threads contend in OpenSSL init
+    PROVIDERS,   // the same cipher matrix under default, FIPS, legacy and custom providers
+    LIBS,        // the same cipher matrix against several libcrypto builds, one child process each
+    SESSION,     // per-message full cipher init versus IV-only re-init of a keyed session
+    TENANTS,     // many-key Zipf workload through an LRU cache of pre-keyed contexts
+    REPLAY,      // replay of a recorded message trace, with latency percentiles
+    IMIX,        // weighted packet-size mixes (IMIX, jumbo frames, custom) per cipher
+};
+
+// how the CPU caches are treated before each timed sample
+enum class CpuCacheMode {
+    WARM,   // re-use the same hot buffers every iteration (default)
+    FLUSH,  // clflush input and output buffers before every sample
+    ROTATE, // cycle through distinct buffers whose total size exceeds the LLC
+};
+
+// how the suite checks that decryption recovers the plaintext
+enum class VerifyMode {
+    FULL,   // keep the recovered plaintext and compare it byte by byte (default)
+    DIGEST, // hash every recovered plaintext on a helper thread and compare digests
+};
+
+// how --mode=replay issues the messages of a trace
+enum class ReplayPacing {
+    FULL,     // back to back, as fast as possible (default)
+    RECORDED, // each message waits for its recorded arrival time
+};
+
+// command-line configuration of the benchmark
+struct BenchOptions {
+    bool showHelp = false;
+    BenchMode mode = BenchMode::SUITE;         // --mode=suite|wss|...
+    std::vector<CipherType> ciphers = {        // --ciphers=aes,camellia,sm4
+        CipherType::AES,
+        CipherType::CAMELLIA,
+        CipherType::SM4
+    };
+    std::vector<int> threadCounts;             // --threads=1,2,4 (empty: 1, 2, 4, ... all CPUs)
+    std::vector<size_t> datasetSizes;          // --sizes=64M,1G: extra generated datasets for the suite
+                                               // (message sizes for the other buffer/API modes)
+    std::vector<int> fragmentCounts;           // --fragments=1,4,16: fragments per message for --mode=gather
+    int batchSize = 256;                       // --batch-size=N: messages per batch (batch, multistream)
+    std::vector<BackendType> backends;         // --backends=evp,lowlevel,...: for --mode=backends (empty: all)
+    std::vector<std::string> providers;        // --providers=fips,base: OpenSSL providers to load (empty: default)
+    std::string cipherProperties;              // --properties=QUERY: property query for fetching ciphers
+    std::vector<std::string> libcryptoDirs;    // --libcrypto=LABEL=DIR,...: builds for --mode=libs
+    bool libWorker = false;                    // --lib-worker: internal, a --mode=libs child process
+    std::vector<int> keyCounts;                // --keys=16,256,4096: distinct keys for --mode=tenants
+    int keyCacheSize = 1024;                   // --key-cache=N: keyed contexts kept by --mode=tenants
+    double zipfExponent = 1.0;                 // --zipf=S: key popularity skew for --mode=tenants (0: uniform)
+    std::string tracePath;                     // --trace=FILE: message trace for --mode=replay
+    ReplayPacing pacing = ReplayPacing::FULL;  // --pacing=full|recorded
+    std::vector<std::string> packetMixes;      // --mixes=imix,jumbo: built-in mixes for --mode=imix (empty: all)
+    std::vector<std::pair<size_t, int>> customMix; // --mix=64:7,576:4,1500:1: extra size:weight mix
+    size_t messageSize = 4096;                 // --message-size=BYTES (K/M/G suffixes allowed)
+    BufferLayout layout;                       // --page-size=base|thp|2m|1g, --input-offset=N, --output-offset=N,
+                                               // --mem-node=N
+    int cpuNode = -1;                          // --cpu-node=N: run worker threads on this NUMA node only
+    int timedIters = 5;                        // --iterations=N
+    bool coldPageCache = false;                // --cold-page-cache
+    CpuCacheMode cpuCache = CpuCacheMode::WARM; // --cpu-cache=warm|flush|rotate
+    VerifyMode verify = VerifyMode::FULL;      // --verify=full|digest
+    std::string digestName = "SHA256";         // --digest=NAME (any EVP digest, e.g. BLAKE2b512)
+    size_t streamSize = size_t{256} << 20;     // --stream-size=BYTES for --mode=stream
+    size_t chunkSize = size_t{1} << 20;        // --chunk-size=BYTES for --mode=stream
+    bool strictAlloc = false;                  // --strict-alloc: fail if allocation-free paths allocate
+};
+
+// parse argv into BenchOptions, throws std::invalid_argument on unknown or malformed options
+BenchOptions parseArgs(int argc, char** argv);
+
+// print the command-line help text to stdout
+void printUsage(const std::string& program);
+
+std::string cpuCacheModeToString(CpuCacheMode mode);
+std::string benchModeToString(BenchMode mode);
+
+// parse a byte count with an optional K/M/G (binary) suffix, e.g. "4K" or "2M"
+size_t parseByteSize(const std::string& name, const std::string& value);
+
+#endif // BENCH_OPTIONS_HPP
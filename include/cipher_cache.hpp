@@ -0,0 +1,39 @@
+#ifndef CIPHER_CACHE_HPP
+#define CIPHER_CACHE_HPP
+
+#include "crypto_utils.hpp"
+
+#include <cstdint>
+#include <string>
+
+// Explicitly fetched OpenSSL 3 ciphers. The legacy accessors (EVP_aes_128_cbc(),
+// EVP_get_cipherbyname()) return static objects without an implementation, so every
+// EVP_CipherInit_ex on them looks the algorithm up in the provider store again ("implicit
+// fetch"). The cache instead holds one EVP_CIPHER_fetch() result per (name, property query) for
+// the life of the process, so init only binds the context to an already resolved provider
+// implementation. All of crypto_utils fetches its ciphers through here.
+
+// OpenSSL name of the CBC cipher behind a CipherType, e.g. "AES-128-CBC"
+std::string evpCipherName(CipherType cipher);
+
+// the static legacy EVP_CIPHER for a CipherType (EVP_aes_128_cbc() etc.), which is implicitly
+// fetched again on every init; only for measuring that cost against fetchCipher
+const evp_cipher_st* legacyCipher(CipherType cipher);
+
+// The cached EVP_CIPHER for `name` under the property query `properties` (e.g. "provider=default",
+// empty for no query), fetched from the default library context on first use. Thread-safe; the
+// pointer stays valid until clearCipherCache() or process exit. Throws std::runtime_error if no
+// loaded provider implements the cipher.
+const evp_cipher_st* fetchCipher(const std::string& name, const std::string& properties = "");
+
+// number of (name, property query) entries currently cached
+size_t cipherCacheSize();
+
+// Free every cached cipher. Only call this while no other thread is using a pointer returned by
+// fetchCipher or evpCipher, e.g. between benchmark phases. The cache is also freed at exit.
+void clearCipherCache();
+
+// incremented by clearCipherCache, so per-thread memos of fetched ciphers know to refetch
+uint64_t cipherCacheGeneration();
+
+#endif // CIPHER_CACHE_HPP
@@ -0,0 +1,68 @@
+#ifndef CRYPTO_BACKEND_HPP
+#define CRYPTO_BACKEND_HPP
+
+#include "crypto_utils.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// implementations of the benchmark ciphers behind the CryptoBackend interface (--backends=...)
+enum class BackendType {
+    EVP,        // EVP_EncryptInit_ex/Update/Final_ex on a fresh context (what crypto_utils does)
+    EVP_CIPHER, // one reused context, padding done here, data through the one-shot EVP_Cipher()
+    LOWLEVEL,   // deprecated direct calls: AES_cbc_encrypt, Camellia_cbc_encrypt (no SM4)
+    INTREE,     // the in-tree AES-NI/VAES kernels from aes_kernels.hpp (AES only)
+    AFALG,      // the Linux kernel crypto API through AF_ALG skcipher sockets
+};
+
+std::string backendTypeToString(BackendType backend);
+
+// inverse of backendTypeToString, throws std::invalid_argument for unknown names
+BackendType backendTypeFromString(const std::string& name);
+
+// every backend type, in declaration order
+std::vector<BackendType> allBackendTypes();
+
+// One way of running the CBC ciphers. Every backend has the same contract as
+// encrypt_into_with_timing/decrypt_into_with_timing in crypto_utils.hpp (PKCS#7 padding, `out`
+// room for length + cipherBlockSize(cipher), time covers key setup and cipher work), so the same
+// workload can be timed through each of them.
+class CryptoBackend {
+public:
+    virtual ~CryptoBackend() = default;
+
+    virtual BackendType type() const = 0;
+
+    // false if this backend cannot run `cipher` in this build or on this machine
+    virtual bool supports(CipherType cipher) const = 0;
+
+    // system calls issued by encryptInto/decryptInto so far (0 for the userspace backends)
+    virtual uint64_t syscalls() const { return 0; }
+
+    // Returns pair<ciphertextLength, timeMs>; throws std::runtime_error on failure
+    virtual std::pair<size_t, double> encryptInto(
+        CipherType cipher,
+        const unsigned char* in,
+        size_t length,
+        unsigned char* out,
+        const std::vector<unsigned char>& key,
+        const std::vector<unsigned char>& iv
+    ) = 0;
+
+    // Returns pair<plaintextLength, timeMs>; throws std::runtime_error on failure or bad padding
+    virtual std::pair<size_t, double> decryptInto(
+        CipherType cipher,
+        const unsigned char* in,
+        size_t length,
+        unsigned char* out,
+        const std::vector<unsigned char>& key,
+        const std::vector<unsigned char>& iv
+    ) = 0;
+};
+
+std::unique_ptr<CryptoBackend> makeBackend(BackendType backend);
+
+#endif // CRYPTO_BACKEND_HPP
@@ -1,10 +1,67 @@
 #ifndef CRYPTO_UTILS_HPP
 #define CRYPTO_UTILS_HPP
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <utility>
 
+// Allocator that default-initialises instead of value-initialising: vector<T>(n) and resize(n)
+// leave new elements uninitialised rather than zero-filling them. For output buffers that are
+// overwritten right away, this saves one full write pass over the memory.
+template <typename T, typename Base = std::allocator<T>>
+class DefaultInitAllocator : public Base {
+public:
+    using Base::Base;
+    DefaultInitAllocator() = default;
+    template <typename U>
+    DefaultInitAllocator(const DefaultInitAllocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U>>& other)
+        : Base(other) {}
+
+    template <typename U>
+    struct rebind {
+        using other = DefaultInitAllocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+    };
+
+    // no arguments: default-initialise (a no-op for unsigned char)
+    template <typename U>
+    void construct(U* p) {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        std::allocator_traits<Base>::construct(static_cast<Base&>(*this), p, std::forward<Args>(args)...);
+    }
+};
+
+// byte buffer for cipher output: sized up front, then filled by OpenSSL, never zeroed first
+using ByteBuffer = std::vector<unsigned char, DefaultInitAllocator<unsigned char>>;
+
+// non-owning, read-only view of a byte range (C++17 has no std::span); converts implicitly
+// from std::vector (any allocator, e.g. ByteBuffer) so the functions below accept vectors and
+// shared dataset memory alike
+class ByteSpan {
+public:
+    ByteSpan() = default;
+    ByteSpan(const unsigned char* data, size_t size) : data_(data), size_(size) {}
+    template <typename Alloc>
+    ByteSpan(const std::vector<unsigned char, Alloc>& bytes) : data_(bytes.data()), size_(bytes.size()) {}
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+    const unsigned char* begin() const { return data_; }
+    const unsigned char* end() const { return data_ + size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// byte-wise comparison of two views (also works between a vector and a view)
+bool operator==(ByteSpan a, ByteSpan b);
+bool operator!=(ByteSpan a, ByteSpan b);
+
 // define an enum for cipher types
 
 enum class CipherType {
@@ -17,9 +74,9 @@ enum class CipherType {
 std::vector<unsigned char> generateRandomBytes(size_t length); // size : number of bytes (16 for 128-bit key/IV)
 
 // encrypt data using specified cipher in CBC mode
-std::vector<unsigned char> encrypt(
+ByteBuffer encrypt(
     CipherType cipher,
-    const std::vector<unsigned char>& plaintext,
+    ByteSpan plaintext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 );
@@ -29,9 +86,9 @@ std::vector<unsigned char> encrypt(
 // ciphertext: data to decrypt
 // key: encryption key (16 bytes for 128-bit key)
 // iv: initialization vector (16 bytes for 128-bit IV)
-std::vector<unsigned char> decrypt(
+ByteBuffer decrypt(
     CipherType cipher,
-    const std::vector<unsigned char>& ciphertext,
+    ByteSpan ciphertext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 );
@@ -39,12 +96,15 @@ std::vector<unsigned char> decrypt(
 // helper function to convert CipherType to string (for logging/debugging)
 std::string cipherTypeToString(CipherType cipher);
 
+// inverse of cipherTypeToString (case-insensitive), throws std::invalid_argument for unknown names
+CipherType cipherTypeFromString(const std::string& name);
+
 // Encrypt data using specified cipher in CBC mode and measure only the crypto time
 // (from EVP_EncryptInit_ex through EVP_EncryptFinal_ex) using steady_clock.
 // Returns pair<ciphertext, timeMs>
-std::pair<std::vector<unsigned char>, double> encrypt_with_timing(
+std::pair<ByteBuffer, double> encrypt_with_timing(
     CipherType cipher,
-    const std::vector<unsigned char>& plaintext,
+    ByteSpan plaintext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 );
@@ -52,11 +112,276 @@ std::pair<std::vector<unsigned char>, double> encrypt_with_timing(
 // Decrypt data using specified cipher in CBC mode and measure only the crypto time
 // (from EVP_DecryptInit_ex through EVP_DecryptFinal_ex) using steady_clock.
 // Returns pair<plaintext, timeMs>
-std::pair<std::vector<unsigned char>, double> decrypt_with_timing(
+std::pair<ByteBuffer, double> decrypt_with_timing(
+    CipherType cipher,
+    ByteSpan ciphertext,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// block size in bytes of the cipher (the most padding can add to a message)
+size_t cipherBlockSize(CipherType cipher);
+
+// Encrypt `length` bytes from `in` into the caller-provided buffer `out` and measure only the
+// crypto time (EVP_EncryptInit_ex through EVP_EncryptFinal_ex). `out` must have room for
+// length + cipherBlockSize(cipher) bytes. Lets callers control where the buffers live.
+// Returns pair<ciphertextLength, timeMs>
+std::pair<size_t, double> encrypt_into_with_timing(
+    CipherType cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// Decrypt `length` bytes from `in` into the caller-provided buffer `out` (at least `length`
+// bytes) and measure only the crypto time (EVP_DecryptInit_ex through EVP_DecryptFinal_ex).
+// Returns pair<plaintextLength, timeMs>
+std::pair<size_t, double> decrypt_into_with_timing(
+    CipherType cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// The same two functions for any EVP cipher by OpenSSL name (e.g. "AES-256-CTR"), so other
+// implementations can be checked and timed against EVP on ciphers CipherType does not list.
+// Throws std::runtime_error for unknown names.
+std::pair<size_t, double> evp_encrypt_into_with_timing(
+    const std::string& cipherName,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+std::pair<size_t, double> evp_decrypt_into_with_timing(
+    const std::string& cipherName,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// length of the CBC ciphertext of a `length`-byte message: PKCS#7 padding always adds
+// 1..cipherBlockSize(cipher) bytes
+size_t paddedLength(CipherType cipher, size_t length);
+
+// In-place encryption: the ciphertext overwrites the plaintext in `data` (EVP allows the output to
+// alias the input exactly, never partially). `data` grows to paddedLength(); reserve that much
+// capacity beforehand to avoid a reallocation.
+void encrypt_in_place(
     CipherType cipher,
-    const std::vector<unsigned char>& ciphertext,
+    ByteBuffer& data,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 );
 
+// In-place decryption: the plaintext overwrites the ciphertext in `data`, which then shrinks by
+// the padding
+void decrypt_in_place(
+    CipherType cipher,
+    ByteBuffer& data,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// Encrypt the first `length` bytes at `data` in place and measure only the crypto time.
+// `capacity` is the size of the buffer at `data`; it must be at least paddedLength(cipher, length)
+// (throws std::runtime_error otherwise). Returns pair<ciphertextLength, timeMs>
+std::pair<size_t, double> encrypt_in_place_with_timing(
+    CipherType cipher,
+    unsigned char* data,
+    size_t length,
+    size_t capacity,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// Decrypt `length` bytes at `data` in place and measure only the crypto time.
+// Returns pair<plaintextLength, timeMs>
+std::pair<size_t, double> decrypt_in_place_with_timing(
+    CipherType cipher,
+    unsigned char* data,
+    size_t length,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// one message of a batch: its input, its own IV and where its output goes
+struct BatchItem {
+    ByteSpan input;
+    const unsigned char* iv = nullptr; // 16 bytes (the cipher's IV length)
+    unsigned char* out = nullptr;      // room for input.size() + cipherBlockSize(cipher) bytes
+    size_t outLength = 0;              // bytes written, set by encrypt_batch/decrypt_batch
+};
+
+// Encrypt every message of a batch under one key, each with its own IV. One context is created and
+// keyed for the whole batch; per message only the IV is reset (EVP_CipherInit_ex with a null
+// cipher and key), so the per-message cost is the cipher work plus a few calls instead of a
+// context allocation and key schedule. Throws std::runtime_error on OpenSSL failures.
+void encrypt_batch(
+    CipherType cipher,
+    std::vector<BatchItem>& items,
+    const std::vector<unsigned char>& key
+);
+
+// decrypt every message of a batch under one key (same rules as encrypt_batch)
+void decrypt_batch(
+    CipherType cipher,
+    std::vector<BatchItem>& items,
+    const std::vector<unsigned char>& key
+);
+
+// opaque OpenSSL types, so including this header does not pull in <openssl/evp.h>
+struct evp_cipher_st;
+struct evp_cipher_ctx_st;
+struct evp_md_ctx_st;
+
+// the explicitly fetched EVP_CIPHER behind a CipherType (see cipher_cache.hpp), for code that
+// drives EVP itself; throws std::runtime_error for an unsupported type
+const evp_cipher_st* evpCipher(CipherType cipher);
+
+// evp_encrypt_into_with_timing/evp_decrypt_into_with_timing for an EVP_CIPHER the caller fetched
+// itself, e.g. from another library context or under another property query
+std::pair<size_t, double> evp_encrypt_into_with_timing(
+    const evp_cipher_st* cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+std::pair<size_t, double> evp_decrypt_into_with_timing(
+    const evp_cipher_st* cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// Incremental CBC encryption or decryption of a stream delivered in chunks: partial blocks are
+// carried between update() calls and padding is added/checked by finish(). Memory use does not
+// depend on the stream length. Move-only; throws std::runtime_error on OpenSSL failures.
+class CipherStream {
+public:
+    CipherStream(
+        CipherType cipher,
+        bool encrypt,
+        const std::vector<unsigned char>& key,
+        const std::vector<unsigned char>& iv
+    );
+    ~CipherStream();
+    CipherStream(CipherStream&& other) noexcept;
+    CipherStream& operator=(CipherStream&& other) noexcept;
+    CipherStream(const CipherStream&) = delete;
+    CipherStream& operator=(const CipherStream&) = delete;
+
+    // process `in`; `out` needs room for in.size() + cipherBlockSize() bytes. Returns bytes written
+    size_t update(ByteSpan in, unsigned char* out);
+
+    // end of stream: writes the last (padded) block; `out` needs cipherBlockSize() bytes.
+    // Returns bytes written
+    size_t finish(unsigned char* out);
+
+private:
+    evp_cipher_ctx_st* ctx_ = nullptr;
+    bool encrypt_ = true;
+};
+
+// Many independent CBC messages under one key, each with its own IV. The key schedule is computed
+// once by the constructor; each message only resets the IV and the partial-block state
+// (EVP_CipherInit_ex with no cipher and no key) instead of redoing the whole cipher and key setup
+// as encrypt()/decrypt() do. Output equals encrypt()/decrypt() with the same key and IV.
+// Move-only; throws std::runtime_error on OpenSSL failures and, when decrypting, bad padding.
+class CipherSession {
+public:
+    CipherSession(CipherType cipher, bool encrypt, const std::vector<unsigned char>& key);
+    ~CipherSession();
+    CipherSession(CipherSession&& other) noexcept;
+    CipherSession& operator=(CipherSession&& other) noexcept;
+    CipherSession(const CipherSession&) = delete;
+    CipherSession& operator=(const CipherSession&) = delete;
+
+    // one whole message with its IV (cipherBlockSize bytes); `out` needs room for
+    // in.size() + cipherBlockSize bytes and may equal in.data(). Returns bytes written
+    size_t process(ByteSpan in, const unsigned char* iv, unsigned char* out);
+
+    // process() timed from the IV reset through the final block, like the *_into_with_timing
+    // functions. Returns pair<bytesWritten, timeMs>
+    std::pair<size_t, double> process_with_timing(ByteSpan in, const unsigned char* iv, unsigned char* out);
+
+private:
+    evp_cipher_ctx_st* ctx_ = nullptr;
+    bool encrypt_ = true;
+};
+
+// Gather (iovec-style) encryption of a message scattered over several fragments, e.g. a header
+// and body slices: the fragments are fed to one CipherStream in order, so partial blocks carry
+// across fragment boundaries and the result equals encrypt() of their concatenation, without
+// copying them together first. `out` needs room for the total length + cipherBlockSize(cipher)
+// bytes. Returns bytes written
+size_t encrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// Gather decryption of a ciphertext scattered over several fragments (same rules as above)
+size_t decrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// gather encryption/decryption into a new buffer
+ByteBuffer encrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+ByteBuffer decrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+);
+
+// Incremental message digest over data delivered in chunks (EVP digest by name, e.g.
+// "SHA256", "BLAKE2b512", "BLAKE2s256"). Throws std::runtime_error for unknown digests.
+class StreamDigest {
+public:
+    explicit StreamDigest(const std::string& name = "SHA256");
+    ~StreamDigest();
+    StreamDigest(const StreamDigest&) = delete;
+    StreamDigest& operator=(const StreamDigest&) = delete;
+
+    void update(ByteSpan data);
+
+    // digest of everything passed to update(); the object cannot be updated afterwards
+    std::vector<unsigned char> finish();
+
+private:
+    evp_md_ctx_st* ctx_ = nullptr;
+};
+
+// one-shot digest of a byte range (see StreamDigest for names)
+std::vector<unsigned char> digestBytes(ByteSpan data, const std::string& name = "SHA256");
+
+// lowercase hex encoding, e.g. for printing digests
+std::string toHex(ByteSpan bytes);
+
 #endif // CRYPTO_UTILS_HPP
@@ -0,0 +1,32 @@
+#ifndef DATASET_REGISTRY_HPP
+#define DATASET_REGISTRY_HPP
+
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <functional>
+#include <map>
+#include <string>
+
+// Owns every benchmark input. Each dataset is loaded from disk (or generated) exactly once
+// into page-aligned memory that is then made read-only, and every cipher/thread works on
+// ByteSpan views of it, so memory and startup time do not grow with the number of ciphers.
+// Loading is not thread-safe; the returned spans may be shared freely once loaded and stay
+// valid for the registry's lifetime.
+class DatasetRegistry {
+public:
+    // contents of the file at `path`, read on first use
+    ByteSpan load(const std::string& path);
+
+    // `size` bytes named `name`, produced by fill(buffer, size) on first use
+    ByteSpan generate(const std::string& name, size_t size,
+                      const std::function<void(unsigned char*, size_t)>& fill);
+
+    // total bytes held by all datasets
+    size_t totalBytes() const;
+
+private:
+    std::map<std::string, AlignedBuffer> datasets_;
+};
+
+#endif // DATASET_REGISTRY_HPP
@@ -0,0 +1,62 @@
+#ifndef KEY_CACHE_HPP
+#define KEY_CACHE_HPP
+
+#include "crypto_utils.hpp"
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// LRU cache of pre-keyed EVP_CIPHER_CTX templates for workloads that mix many keys (one per
+// tenant, say). A hit clones the key's template into a working context with EVP_CIPHER_CTX_copy
+// and only sets the IV, so the key schedule is not recomputed; a miss keys a template (re-using
+// the least recently used one when full) first. Not thread-safe; use one cache per thread.
+class KeyedContextCache {
+public:
+    // throws std::invalid_argument for a zero capacity
+    KeyedContextCache(CipherType cipher, bool encrypt, size_t capacity);
+    ~KeyedContextCache();
+    KeyedContextCache(const KeyedContextCache&) = delete;
+    KeyedContextCache& operator=(const KeyedContextCache&) = delete;
+
+    // Encrypt or decrypt one whole message under key `keyId` (whose bytes are `key`; only read on a
+    // miss) with its own IV. `out` needs room for in.size() + cipherBlockSize bytes.
+    // Returns bytes written; throws std::runtime_error on OpenSSL failures or bad padding.
+    size_t process(uint64_t keyId, const std::vector<unsigned char>& key, ByteSpan in,
+                   const unsigned char* iv, unsigned char* out);
+
+    // process() timed from the key lookup through the final block, like the *_into_with_timing
+    // functions; returns {bytes written, milliseconds}
+    std::pair<size_t, double> process_with_timing(uint64_t keyId, const std::vector<unsigned char>& key,
+                                                  ByteSpan in, const unsigned char* iv, unsigned char* out);
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return lru_.size(); }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+    uint64_t evictions() const { return evictions_; }
+    void resetStats() { hits_ = misses_ = evictions_ = 0; }
+
+private:
+    struct Entry {
+        uint64_t keyId;
+        evp_cipher_ctx_st* keyed;
+    };
+
+    // the keyed template for `keyId`, moved to the front of the LRU list
+    evp_cipher_ctx_st* lookup(uint64_t keyId, const std::vector<unsigned char>& key);
+
+    const evp_cipher_st* cipher_;
+    bool encrypt_;
+    size_t capacity_;
+    evp_cipher_ctx_st* work_;
+    std::list<Entry> lru_; // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+};
+
+#endif // KEY_CACHE_HPP
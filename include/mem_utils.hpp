@@ -0,0 +1,131 @@
+#ifndef MEM_UTILS_HPP
+#define MEM_UTILS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// evict a file's pages from the OS page cache (posix_fadvise POSIX_FADV_DONTNEED),
+// so the next read of the file has to go to the storage device
+void dropFilePageCache(const std::string& filename);
+
+// flush every CPU cache line covering [data, data + length) back to memory
+// (clflush on x86, eviction by streaming a large buffer elsewhere)
+void flushCacheLines(const void* data, size_t length);
+
+// one data or unified CPU cache level as described by sysfs
+struct CacheLevel {
+    int level;         // 1 for L1d, 2 for L2, ...
+    size_t sizeBytes;  // capacity of one instance of this cache
+    int sharedCpus;    // number of CPUs sharing one instance
+};
+
+// data/unified cache levels of cpu0 from /sys/devices/system/cpu/cpu0/cache, ordered by level
+// (empty if sysfs does not describe the caches)
+std::vector<CacheLevel> detectCacheHierarchy();
+
+// size of a CPU cache line in bytes (64 if it cannot be detected)
+size_t cacheLineSize();
+
+// size of the last-level CPU cache in bytes, read from sysfs
+// (falls back to 32 MiB if it cannot be detected)
+size_t lastLevelCacheSize();
+
+// one NUMA node and the CPUs that belong to it
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+// NUMA nodes from /sys/devices/system/node (a single node 0 holding every CPU if sysfs has none)
+std::vector<NumaNode> detectNumaNodes();
+
+// bind the pages of [data, data + length) to `node` with mbind(MPOL_BIND), moving pages that
+// are already faulted in; `data` must be page aligned. Throws std::runtime_error on failure.
+void bindMemoryToNode(void* data, size_t length, int node);
+
+// NUMA node currently holding the page at `data` (get_mempolicy), or -1 if unknown
+int nodeOfAddress(const void* data);
+
+// page size backing an AlignedBuffer
+enum class PageSize {
+    BASE,     // plain anonymous mapping, kernel default policy (normally 4 KiB pages)
+    THP,      // 2 MiB aligned mapping with madvise(MADV_HUGEPAGE) (transparent huge pages)
+    HUGE_2MB, // MAP_HUGETLB 2 MiB pages (needs pages reserved in /proc/sys/vm/nr_hugepages)
+    HUGE_1GB, // MAP_HUGETLB 1 GiB pages (needs reserved 1 GiB pages)
+};
+
+std::string pageSizeToString(PageSize pages);
+
+// Page-aligned memory from an anonymous mmap, optionally on huge pages and bound to a NUMA
+// node (numaNode < 0: first-touch placement). Every page is touched on construction so page
+// faults never land in a timed loop. Move-only.
+// Throws std::runtime_error if the mapping fails (e.g. no huge pages reserved).
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t size, PageSize pages = PageSize::BASE, int numaNode = -1);
+    ~AlignedBuffer();
+    AlignedBuffer(AlignedBuffer&& other) noexcept;
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    unsigned char* data() { return data_; }
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+    PageSize pageSize() const { return pages_; }
+
+    // drop write access to the whole mapping (mprotect PROT_READ); stray writes then fault
+    void makeReadOnly();
+
+private:
+    void release();
+
+    void* mapping_ = nullptr;      // start of the mmap'd region
+    size_t mappedBytes_ = 0;       // length of the mmap'd region
+    unsigned char* data_ = nullptr; // aligned start handed out to callers
+    size_t size_ = 0;
+    PageSize pages_ = PageSize::BASE;
+};
+
+// where BufferRing slots live: page size, how far past a cache-line boundary each
+// input/output buffer starts (0 = cache-line aligned, 1 = maximally misaligned for SIMD)
+// and which NUMA node holds the memory (-1 = first touch)
+struct BufferLayout {
+    PageSize pageSize = PageSize::BASE;
+    size_t inputOffset = 0;
+    size_t outputOffset = 0;
+    int numaNode = -1;
+};
+
+// A set of equally sized input/output buffer pairs carved out of a single arena.
+// Benchmarks visit the slots round-robin, which controls how much distinct memory
+// the timed loop touches (e.g. more than the LLC, so every sample starts cold).
+class BufferRing {
+public:
+    // inputSize: bytes per input buffer, outputSize: bytes per output buffer,
+    // totalBytes: minimum combined size of all slots (at least one slot is always created)
+    BufferRing(size_t inputSize, size_t outputSize, size_t totalBytes, const BufferLayout& layout = {});
+
+    size_t slots() const { return slots_; }
+    size_t inputSize() const { return inputSize_; }
+    size_t outputSize() const { return outputSize_; }
+
+    unsigned char* input(size_t slot);
+    unsigned char* output(size_t slot);
+
+    // copy `length` bytes of `src` into every input buffer
+    void fillInputs(const unsigned char* src, size_t length);
+
+private:
+    size_t inputSize_;
+    size_t outputSize_;
+    BufferLayout layout_;
+    size_t outputStart_; // offset of the output buffer within a slot
+    size_t stride_;      // bytes per slot, rounded up to a cache line
+    size_t slots_;
+    AlignedBuffer arena_;
+};
+
+#endif // MEM_UTILS_HPP
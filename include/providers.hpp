@@ -0,0 +1,62 @@
+#ifndef PROVIDERS_HPP
+#define PROVIDERS_HPP
+
+#include "crypto_utils.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// opaque OpenSSL types, so including this header does not pull in <openssl/provider.h>
+struct ossl_lib_ctx_st;
+struct ossl_provider_st;
+
+// Which OpenSSL providers supply the ciphers, and the property query they are fetched with.
+// Loading any provider explicitly stops OpenSSL from loading "default" on its own, so a FIPS-only
+// configuration is {"fips", "base"} with the query "fips=yes".
+struct ProviderConfig {
+    std::string name;                   // label in reports
+    std::vector<std::string> providers; // loaded in this order; empty: OpenSSL's default provider
+    std::string properties;             // default property query, e.g. "fips=yes" (empty: none)
+};
+
+// default, FIPS-only and default plus legacy, the configurations --mode=providers compares
+std::vector<ProviderConfig> standardProviderConfigs();
+
+// "default+legacy (fips=no)" style description of a configuration
+std::string describeProviderConfig(const ProviderConfig& config);
+
+// Load config.providers into the default library context and make config.properties its default
+// property query, so every cipher fetched afterwards (crypto_utils, implicit fetches) follows the
+// configuration. Call before any benchmark work; providers stay loaded until exit. Throws
+// std::runtime_error if a provider cannot be loaded or the query does not parse.
+void applyProviderConfig(const ProviderConfig& config);
+
+// A private library context with a configuration's providers loaded, so several configurations
+// can be benchmarked side by side in one process. Move-only.
+class ProviderContext {
+public:
+    // throws std::runtime_error if a provider cannot be loaded (e.g. no FIPS module installed)
+    explicit ProviderContext(const ProviderConfig& config);
+    ~ProviderContext();
+    ProviderContext(ProviderContext&& other) noexcept;
+    ProviderContext& operator=(ProviderContext&& other) noexcept;
+    ProviderContext(const ProviderContext&) = delete;
+    ProviderContext& operator=(const ProviderContext&) = delete;
+
+    // the cipher `name` fetched from this context under its property query, cached for the
+    // lifetime of the context; nullptr if no loaded provider implements it
+    const evp_cipher_st* fetch(const std::string& name);
+
+    // provider name reported by OpenSSL for a cipher returned by fetch()
+    static std::string providerOf(const evp_cipher_st* cipher);
+
+private:
+    void release();
+
+    ossl_lib_ctx_st* libctx_;
+    std::vector<ossl_provider_st*> providers_;
+    std::map<std::string, evp_cipher_st*> ciphers_;
+};
+
+#endif // PROVIDERS_HPP
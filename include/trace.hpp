@@ -0,0 +1,26 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "crypto_utils.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// one message of a recorded workload
+struct TraceRecord {
+    size_t size = 0;                   // plaintext bytes
+    CipherType cipher = CipherType::AES;
+    bool encrypt = true;
+    double gapUs = 0.0;                // time since the previous message arrived
+    uint32_t keyId = 0;                // messages with the same id share a key
+};
+
+// Reads a trace file: one message per line as
+//     size,cipher,direction[,inter-arrival-us[,key-id]]
+// e.g. "1500,aes,encrypt,12.5,3". Cipher names are those of --ciphers, direction is encrypt or
+// decrypt; blank lines and lines starting with '#' are skipped. Throws std::runtime_error naming
+// the file and line for unreadable files or malformed records.
+std::vector<TraceRecord> loadTrace(const std::string& path);
+
+#endif // TRACE_HPP
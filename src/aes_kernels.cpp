@@ -0,0 +1,574 @@
+#include "aes_kernels.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+// GCC 12's avx512fintrin.h builds some vectors from a deliberately uninitialised __Y, which warns
+// once the intrinsics are inlined into the optimised kernels below
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#define BENCH_HAVE_AESNI 1
+#endif
+
+std::string aesModeToString(AesMode mode) {
+    switch (mode) {
+        case AesMode::CBC:
+            return "CBC";
+        case AesMode::CTR:
+            return "CTR";
+        default:
+            return "unknown";
+    }
+}
+
+std::string aesIsaToString(AesIsa isa) {
+    switch (isa) {
+        case AesIsa::AESNI:
+            return "AES-NI";
+        case AesIsa::VAES:
+            return "VAES";
+        default:
+            return "unknown";
+    }
+}
+
+bool aesKernelsOptimised() {
+#ifdef __OPTIMIZE__
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::string aesEvpName(AesMode mode, size_t keyBytes) {
+    return "AES-" + std::to_string(keyBytes * 8) + "-" + aesModeToString(mode);
+}
+
+#ifdef BENCH_HAVE_AESNI
+// compile single functions for AES-NI / VAES without requiring -maes or -mavx512f for the whole build
+#define AESNI_TARGET __attribute__((target("aes,sse4.1")))
+#define VAES_TARGET __attribute__((target("aes,sse4.1,vaes,avx512f,avx512bw")))
+
+namespace {
+const size_t kBlock = 16;
+
+// AES-128 or AES-256 round keys: `enc` for encryption, `dec` in the order aesdec wants them
+// (reversed and passed through InvMixColumns)
+struct AesSchedule {
+    int rounds; // 10 or 14
+    __m128i enc[15];
+    __m128i dec[15];
+};
+
+// one step of the key expansion: spread `key` across its words and mix in the word aeskeygenassist
+// prepared (its top word for the rcon steps, word 2 for the extra AES-256 step)
+AESNI_TARGET __m128i expandStep(__m128i key, __m128i assist) {
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+AESNI_TARGET __m128i rconStep(__m128i key, __m128i assist) {
+    return expandStep(key, _mm_shuffle_epi32(assist, 0xff));
+}
+
+// the AES-256 step between rcon steps: SubWord without rotation or rcon
+AESNI_TARGET __m128i subWordStep(__m128i key, __m128i previous) {
+    return expandStep(key, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(previous, 0x00), 0xaa));
+}
+
+// FIPS-197 key expansion; aeskeygenassist needs its round constant as an immediate
+AESNI_TARGET void expandKey(const unsigned char* key, size_t keyBytes, AesSchedule& s) {
+    __m128i* rk = s.enc;
+    rk[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    if (keyBytes == 16) {
+        s.rounds = 10;
+        rk[1] = rconStep(rk[0], _mm_aeskeygenassist_si128(rk[0], 0x01));
+        rk[2] = rconStep(rk[1], _mm_aeskeygenassist_si128(rk[1], 0x02));
+        rk[3] = rconStep(rk[2], _mm_aeskeygenassist_si128(rk[2], 0x04));
+        rk[4] = rconStep(rk[3], _mm_aeskeygenassist_si128(rk[3], 0x08));
+        rk[5] = rconStep(rk[4], _mm_aeskeygenassist_si128(rk[4], 0x10));
+        rk[6] = rconStep(rk[5], _mm_aeskeygenassist_si128(rk[5], 0x20));
+        rk[7] = rconStep(rk[6], _mm_aeskeygenassist_si128(rk[6], 0x40));
+        rk[8] = rconStep(rk[7], _mm_aeskeygenassist_si128(rk[7], 0x80));
+        rk[9] = rconStep(rk[8], _mm_aeskeygenassist_si128(rk[8], 0x1b));
+        rk[10] = rconStep(rk[9], _mm_aeskeygenassist_si128(rk[9], 0x36));
+    } else {
+        s.rounds = 14;
+        rk[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + 16));
+        rk[2] = rconStep(rk[0], _mm_aeskeygenassist_si128(rk[1], 0x01));
+        rk[3] = subWordStep(rk[1], rk[2]);
+        rk[4] = rconStep(rk[2], _mm_aeskeygenassist_si128(rk[3], 0x02));
+        rk[5] = subWordStep(rk[3], rk[4]);
+        rk[6] = rconStep(rk[4], _mm_aeskeygenassist_si128(rk[5], 0x04));
+        rk[7] = subWordStep(rk[5], rk[6]);
+        rk[8] = rconStep(rk[6], _mm_aeskeygenassist_si128(rk[7], 0x08));
+        rk[9] = subWordStep(rk[7], rk[8]);
+        rk[10] = rconStep(rk[8], _mm_aeskeygenassist_si128(rk[9], 0x10));
+        rk[11] = subWordStep(rk[9], rk[10]);
+        rk[12] = rconStep(rk[10], _mm_aeskeygenassist_si128(rk[11], 0x20));
+        rk[13] = subWordStep(rk[11], rk[12]);
+        rk[14] = rconStep(rk[12], _mm_aeskeygenassist_si128(rk[13], 0x40));
+    }
+    s.dec[0] = s.enc[s.rounds];
+    for (int r = 1; r < s.rounds; ++r) {
+        s.dec[r] = _mm_aesimc_si128(s.enc[s.rounds - r]);
+    }
+    s.dec[s.rounds] = s.enc[0];
+}
+
+AESNI_TARGET __m128i encryptBlock(const AesSchedule& s, __m128i x) {
+    x = _mm_xor_si128(x, s.enc[0]);
+    for (int r = 1; r < s.rounds; ++r) {
+        x = _mm_aesenc_si128(x, s.enc[r]);
+    }
+    return _mm_aesenclast_si128(x, s.enc[s.rounds]);
+}
+
+AESNI_TARGET __m128i decryptBlock(const AesSchedule& s, __m128i x) {
+    x = _mm_xor_si128(x, s.dec[0]);
+    for (int r = 1; r < s.rounds; ++r) {
+        x = _mm_aesdec_si128(x, s.dec[r]);
+    }
+    return _mm_aesdeclast_si128(x, s.dec[s.rounds]);
+}
+
+__m128i load(const unsigned char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+void store(unsigned char* p, __m128i x) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+}
+
+// last CBC plaintext block: the tail of the message followed by PKCS#7 padding
+__m128i paddedBlock(const unsigned char* tail, size_t tailLength) {
+    unsigned char last[kBlock];
+    std::memcpy(last, tail, tailLength);
+    std::memset(last + tailLength, static_cast<int>(kBlock - tailLength), kBlock - tailLength);
+    return load(last);
+}
+
+// CBC encryption is a serial chain, one block at a time whatever the instruction set
+AESNI_TARGET size_t cbcEncrypt(const AesSchedule& s, const unsigned char* in, size_t length,
+                               unsigned char* out, const unsigned char* iv) {
+    const size_t full = length / kBlock;
+    __m128i chain = load(iv);
+    for (size_t b = 0; b < full; ++b) {
+        chain = encryptBlock(s, _mm_xor_si128(load(in + b * kBlock), chain));
+        store(out + b * kBlock, chain);
+    }
+    chain = encryptBlock(s, _mm_xor_si128(paddedBlock(in + full * kBlock, length - full * kBlock), chain));
+    store(out + full * kBlock, chain);
+    return (full + 1) * kBlock;
+}
+
+// CBC decryption of whole blocks, 8 at a time: every block only needs its own ciphertext and the
+// previous one, so the blocks are independent. `prev` carries the last ciphertext block.
+// All ciphertext of a group is loaded before its plaintext is stored, so `out` may equal `in`.
+AESNI_TARGET void cbcDecryptBlocks(const AesSchedule& s, const unsigned char* in, unsigned char* out,
+                                   size_t blocks, __m128i& prev) {
+    size_t b = 0;
+    for (; b + 8 <= blocks; b += 8) {
+        __m128i c[8];
+        __m128i x[8];
+        for (int k = 0; k < 8; ++k) {
+            c[k] = load(in + (b + k) * kBlock);
+            x[k] = _mm_xor_si128(c[k], s.dec[0]);
+        }
+        for (int r = 1; r < s.rounds; ++r) {
+            for (int k = 0; k < 8; ++k) {
+                x[k] = _mm_aesdec_si128(x[k], s.dec[r]);
+            }
+        }
+        for (int k = 0; k < 8; ++k) {
+            x[k] = _mm_aesdeclast_si128(x[k], s.dec[s.rounds]);
+        }
+        store(out + b * kBlock, _mm_xor_si128(x[0], prev));
+        for (int k = 1; k < 8; ++k) {
+            store(out + (b + k) * kBlock, _mm_xor_si128(x[k], c[k - 1]));
+        }
+        prev = c[7];
+    }
+    for (; b < blocks; ++b) {
+        const __m128i c = load(in + b * kBlock);
+        store(out + b * kBlock, _mm_xor_si128(decryptBlock(s, c), prev));
+        prev = c;
+    }
+}
+
+// big-endian 128-bit counter block as two native halves
+struct Counter {
+    uint64_t hi;
+    uint64_t lo;
+
+    explicit Counter(const unsigned char* iv) {
+        std::memcpy(&hi, iv, 8);
+        std::memcpy(&lo, iv + 8, 8);
+        hi = __builtin_bswap64(hi);
+        lo = __builtin_bswap64(lo);
+    }
+
+    // current block in memory order, then step to the next one
+    __m128i next() {
+        const __m128i block = _mm_set_epi64x(static_cast<long long>(__builtin_bswap64(lo)),
+                                             static_cast<long long>(__builtin_bswap64(hi)));
+        if (++lo == 0) {
+            ++hi;
+        }
+        return block;
+    }
+};
+
+// CTR over whole blocks, 8 keystream blocks at a time (each block only depends on its counter)
+AESNI_TARGET void ctrBlocks(const AesSchedule& s, const unsigned char* in, unsigned char* out,
+                            size_t blocks, Counter& counter) {
+    size_t b = 0;
+    for (; b + 8 <= blocks; b += 8) {
+        __m128i x[8];
+        for (int k = 0; k < 8; ++k) {
+            x[k] = _mm_xor_si128(counter.next(), s.enc[0]);
+        }
+        for (int r = 1; r < s.rounds; ++r) {
+            for (int k = 0; k < 8; ++k) {
+                x[k] = _mm_aesenc_si128(x[k], s.enc[r]);
+            }
+        }
+        for (int k = 0; k < 8; ++k) {
+            x[k] = _mm_aesenclast_si128(x[k], s.enc[s.rounds]);
+            store(out + (b + k) * kBlock, _mm_xor_si128(x[k], load(in + (b + k) * kBlock)));
+        }
+    }
+    for (; b < blocks; ++b) {
+        store(out + b * kBlock, _mm_xor_si128(encryptBlock(s, counter.next()), load(in + b * kBlock)));
+    }
+}
+
+// the partial last CTR block: only `length` bytes of keystream are used
+AESNI_TARGET void ctrTail(const AesSchedule& s, const unsigned char* in, unsigned char* out,
+                          size_t length, Counter& counter) {
+    unsigned char keystream[kBlock];
+    store(keystream, encryptBlock(s, counter.next()));
+    for (size_t i = 0; i < length; ++i) {
+        out[i] = in[i] ^ keystream[i];
+    }
+}
+
+// round keys broadcast to all four 128-bit lanes
+struct VaesSchedule {
+    int rounds;
+    __m512i enc[15];
+    __m512i dec[15];
+};
+
+VAES_TARGET void broadcastSchedule(const AesSchedule& s, VaesSchedule& v) {
+    v.rounds = s.rounds;
+    for (int r = 0; r <= s.rounds; ++r) {
+        v.enc[r] = _mm512_broadcast_i32x4(s.enc[r]);
+        v.dec[r] = _mm512_broadcast_i32x4(s.dec[r]);
+    }
+}
+
+// VAES CBC decryption of whole blocks, 16 (4 registers) at a time; returns the blocks done.
+// Each register's "previous ciphertext" operand is its own blocks shifted up by one lane, with the
+// carried block shifted in, so no ciphertext is re-read after plaintext was stored.
+VAES_TARGET size_t cbcDecryptBlocksVaes(const AesSchedule& s, const unsigned char* in, unsigned char* out,
+                                        size_t blocks, __m128i& prev) {
+    VaesSchedule v;
+    broadcastSchedule(s, v);
+    size_t b = 0;
+    for (; b + 16 <= blocks; b += 16) {
+        __m512i c[4];
+        __m512i x[4];
+        for (int k = 0; k < 4; ++k) {
+            c[k] = _mm512_loadu_si512(in + (b + 4 * k) * kBlock);
+            x[k] = _mm512_xor_si512(c[k], v.dec[0]);
+        }
+        for (int r = 1; r < v.rounds; ++r) {
+            for (int k = 0; k < 4; ++k) {
+                x[k] = _mm512_aesdec_epi128(x[k], v.dec[r]);
+            }
+        }
+        const __m512i carried = _mm512_broadcast_i32x4(prev);
+        for (int k = 0; k < 4; ++k) {
+            x[k] = _mm512_aesdeclast_epi128(x[k], v.dec[v.rounds]);
+            // lanes {previous register's lane 3, own lanes 0..2}
+            const __m512i shifted = _mm512_alignr_epi64(c[k], k == 0 ? carried : c[k - 1], 6);
+            _mm512_storeu_si512(out + (b + 4 * k) * kBlock, _mm512_xor_si512(x[k], shifted));
+        }
+        prev = _mm512_extracti32x4_epi32(c[3], 3);
+    }
+    return b;
+}
+
+// VAES CTR over whole blocks, 16 at a time; returns the blocks done. The counters are kept
+// little-endian in 64-bit lanes and byte-swapped per block, which only works while the low half
+// cannot wrap inside a group, so the group loop stops short of a wrap and leaves it to AES-NI.
+VAES_TARGET size_t ctrBlocksVaes(const AesSchedule& s, const unsigned char* in, unsigned char* out,
+                                 size_t blocks, Counter& counter) {
+    VaesSchedule v;
+    broadcastSchedule(s, v);
+    // reverses the 16 bytes of every 128-bit lane: little-endian {lo, hi} -> big-endian block
+    const __m512i byteSwap = _mm512_broadcast_i32x4(
+        _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __m512i laneOffsets = _mm512_set_epi64(0, 3, 0, 2, 0, 1, 0, 0);
+    const __m512i step = _mm512_set_epi64(0, 4, 0, 4, 0, 4, 0, 4);
+    size_t b = 0;
+    for (; b + 16 <= blocks && counter.lo <= UINT64_MAX - 16; b += 16) {
+        __m512i ctr = _mm512_add_epi64(
+            _mm512_set_epi64(static_cast<long long>(counter.hi), static_cast<long long>(counter.lo),
+                             static_cast<long long>(counter.hi), static_cast<long long>(counter.lo),
+                             static_cast<long long>(counter.hi), static_cast<long long>(counter.lo),
+                             static_cast<long long>(counter.hi), static_cast<long long>(counter.lo)),
+            laneOffsets);
+        __m512i x[4];
+        for (int k = 0; k < 4; ++k) {
+            x[k] = _mm512_xor_si512(_mm512_shuffle_epi8(ctr, byteSwap), v.enc[0]);
+            ctr = _mm512_add_epi64(ctr, step);
+        }
+        for (int r = 1; r < v.rounds; ++r) {
+            for (int k = 0; k < 4; ++k) {
+                x[k] = _mm512_aesenc_epi128(x[k], v.enc[r]);
+            }
+        }
+        for (int k = 0; k < 4; ++k) {
+            x[k] = _mm512_aesenclast_epi128(x[k], v.enc[v.rounds]);
+            const __m512i data = _mm512_loadu_si512(in + (b + 4 * k) * kBlock);
+            _mm512_storeu_si512(out + (b + 4 * k) * kBlock, _mm512_xor_si512(x[k], data));
+        }
+        counter.lo += 16;
+    }
+    return b;
+}
+
+size_t kernelEncrypt(AesIsa isa, AesMode mode, const AesSchedule& s, const unsigned char* in,
+                     size_t length, unsigned char* out, const unsigned char* iv) {
+    if (mode == AesMode::CBC) {
+        return cbcEncrypt(s, in, length, out, iv);
+    }
+    Counter counter(iv);
+    const size_t blocks = length / kBlock;
+    size_t done = isa == AesIsa::VAES ? ctrBlocksVaes(s, in, out, blocks, counter) : 0;
+    ctrBlocks(s, in + done * kBlock, out + done * kBlock, blocks - done, counter);
+    ctrTail(s, in + blocks * kBlock, out + blocks * kBlock, length - blocks * kBlock, counter);
+    return length;
+}
+
+size_t kernelDecrypt(AesIsa isa, AesMode mode, const AesSchedule& s, const unsigned char* in,
+                     size_t length, unsigned char* out, const unsigned char* iv) {
+    if (mode == AesMode::CTR) {
+        return kernelEncrypt(isa, mode, s, in, length, out, iv);
+    }
+    if (length == 0 || length % kBlock != 0) {
+        throw std::runtime_error("AES-CBC decryption failed: ciphertext is not a whole number of blocks");
+    }
+    const size_t blocks = length / kBlock;
+    __m128i prev = load(iv);
+    size_t done = isa == AesIsa::VAES ? cbcDecryptBlocksVaes(s, in, out, blocks, prev) : 0;
+    cbcDecryptBlocks(s, in + done * kBlock, out + done * kBlock, blocks - done, prev);
+
+    // PKCS#7: 1..16 bytes, all holding the pad length
+    const unsigned char pad = out[length - 1];
+    bool valid = pad >= 1 && pad <= kBlock;
+    for (size_t i = 0; valid && i < pad; ++i) {
+        valid = out[length - 1 - i] == pad;
+    }
+    if (!valid) {
+        throw std::runtime_error("AES-CBC decryption failed: bad padding");
+    }
+    return length - pad;
+}
+
+// one message being encrypted on a lane of the interleaved CBC kernel
+struct CbcLane {
+    BatchItem* item;
+    size_t block;     // next block to encrypt
+    size_t fullBlocks; // whole plaintext blocks; block == fullBlocks is the padding block
+    __m128i chain;    // previous ciphertext block (the IV at the start)
+};
+
+void startLane(CbcLane& lane, BatchItem& item) {
+    lane.item = &item;
+    lane.block = 0;
+    lane.fullBlocks = item.input.size() / kBlock;
+    lane.chain = load(item.iv);
+}
+
+// next plaintext block of a lane; the last one carries the PKCS#7 padding
+__m128i nextBlock(const CbcLane& lane) {
+    const unsigned char* in = lane.item->input.data() + lane.block * kBlock;
+    if (lane.block < lane.fullBlocks) {
+        return load(in);
+    }
+    return paddedBlock(in, lane.item->input.size() - lane.fullBlocks * kBlock);
+}
+
+// encrypt one block on each of N lanes; the N chains are independent, so the rounds of different
+// lanes issue back to back instead of waiting on each other's latency
+template <int N>
+AESNI_TARGET void encryptStep(const AesSchedule& s, CbcLane* lanes) {
+    __m128i x[N];
+    for (int l = 0; l < N; ++l) {
+        x[l] = _mm_xor_si128(_mm_xor_si128(nextBlock(lanes[l]), lanes[l].chain), s.enc[0]);
+    }
+    for (int r = 1; r < s.rounds; ++r) {
+        for (int l = 0; l < N; ++l) {
+            x[l] = _mm_aesenc_si128(x[l], s.enc[r]);
+        }
+    }
+    for (int l = 0; l < N; ++l) {
+        x[l] = _mm_aesenclast_si128(x[l], s.enc[s.rounds]);
+        lanes[l].chain = x[l];
+        store(lanes[l].item->out + lanes[l].block * kBlock, x[l]);
+    }
+}
+
+void encryptStep(const AesSchedule& s, CbcLane* lanes, int active) {
+    switch (active) {
+        case 1: encryptStep<1>(s, lanes); break;
+        case 2: encryptStep<2>(s, lanes); break;
+        case 3: encryptStep<3>(s, lanes); break;
+        case 4: encryptStep<4>(s, lanes); break;
+        case 5: encryptStep<5>(s, lanes); break;
+        case 6: encryptStep<6>(s, lanes); break;
+        case 7: encryptStep<7>(s, lanes); break;
+        default: encryptStep<8>(s, lanes); break;
+    }
+}
+
+void cbcEncryptInterleaved(std::vector<BatchItem>& items, const unsigned char* key, int lanes) {
+    AesSchedule schedule;
+    expandKey(key, 16, schedule);
+    CbcLane lane[kMaxCbcLanes];
+    size_t next = 0;
+    int active = 0;
+    while (active < lanes && next < items.size()) {
+        startLane(lane[active++], items[next++]);
+    }
+    while (active > 0) {
+        encryptStep(schedule, lane, active);
+        for (int l = 0; l < active;) {
+            CbcLane& current = lane[l];
+            if (current.block++ < current.fullBlocks) {
+                ++l;
+                continue;
+            }
+            // padding block written: the message is done, refill the lane or close it
+            current.item->outLength = current.block * kBlock;
+            if (next < items.size()) {
+                startLane(current, items[next++]);
+                ++l;
+            } else {
+                current = lane[--active];
+            }
+        }
+    }
+}
+}
+#endif
+
+bool aesIsaAvailable(AesIsa isa) {
+#ifdef BENCH_HAVE_AESNI
+    static const bool aesni = __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1");
+    static const bool vaes = aesni && __builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f")
+                             && __builtin_cpu_supports("avx512bw");
+    return isa == AesIsa::VAES ? vaes : aesni;
+#else
+    (void)isa;
+    return false;
+#endif
+}
+
+bool aesniAvailable() {
+    return aesIsaAvailable(AesIsa::AESNI);
+}
+
+namespace {
+std::pair<size_t, double> aes_kernel_with_timing(
+    AesIsa isa,
+    AesMode mode,
+    bool encrypt,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    if (key.size() != 16 && key.size() != 32) {
+        throw std::invalid_argument("AES kernels need a 16 or 32 byte key");
+    }
+    if (iv.size() != 16) {
+        throw std::invalid_argument("AES kernels need a 16 byte IV");
+    }
+    if (!aesIsaAvailable(isa)) {
+        throw std::invalid_argument(aesIsaToString(isa) + " kernels are not available on this CPU/build");
+    }
+#ifdef BENCH_HAVE_AESNI
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    AesSchedule schedule;
+    expandKey(key.data(), key.size(), schedule);
+    const size_t written = encrypt ? kernelEncrypt(isa, mode, schedule, in, length, out, iv.data())
+                                   : kernelDecrypt(isa, mode, schedule, in, length, out, iv.data());
+    auto t1 = clock::now();
+
+    std::chrono::duration<double, std::milli> dt = t1 - t0;
+    return {written, dt.count()};
+#else
+    (void)mode; (void)encrypt; (void)in; (void)length; (void)out;
+    return {0, 0.0};
+#endif
+}
+}
+
+std::pair<size_t, double> aes_kernel_encrypt_into_with_timing(
+    AesIsa isa,
+    AesMode mode,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return aes_kernel_with_timing(isa, mode, true, in, length, out, key, iv);
+}
+
+std::pair<size_t, double> aes_kernel_decrypt_into_with_timing(
+    AesIsa isa,
+    AesMode mode,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return aes_kernel_with_timing(isa, mode, false, in, length, out, key, iv);
+}
+
+void aes128_cbc_encrypt_interleaved(
+    std::vector<BatchItem>& items,
+    const std::vector<unsigned char>& key,
+    int lanes
+) {
+    if (key.size() != 16) {
+        throw std::invalid_argument("AES-128 needs a 16-byte key");
+    }
+    if (lanes < 1 || lanes > kMaxCbcLanes) {
+        throw std::invalid_argument("CBC lane count must be between 1 and " + std::to_string(kMaxCbcLanes));
+    }
+#ifdef BENCH_HAVE_AESNI
+    if (aesniAvailable()) {
+        cbcEncryptInterleaved(items, key.data(), lanes);
+        return;
+    }
+#endif
+    encrypt_batch(CipherType::AES, items, key);
+}
@@ -0,0 +1,91 @@
+#include "alloc_audit.hpp"
+
+#include <openssl/crypto.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<bool> g_counting{false};
+thread_local AllocCounters t_counters;
+
+inline void countCrypto(size_t bytes) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        ++t_counters.cryptoAllocs;
+        t_counters.cryptoBytes += bytes;
+    }
+}
+
+inline void countCxx(size_t bytes) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        ++t_counters.cxxAllocs;
+        t_counters.cxxBytes += bytes;
+    }
+}
+
+void* countingMalloc(size_t size, const char*, int) {
+    countCrypto(size);
+    return std::malloc(size);
+}
+
+void* countingRealloc(void* ptr, size_t size, const char*, int) {
+    countCrypto(size);
+    return std::realloc(ptr, size);
+}
+
+void countingFree(void* ptr, const char*, int) {
+    std::free(ptr);
+}
+
+void* allocateOrThrow(size_t size) {
+    countCxx(size);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* allocateAlignedOrThrow(size_t size, std::align_val_t align) {
+    countCxx(size);
+    const size_t alignment = static_cast<size_t>(align);
+    // aligned_alloc needs the size to be a multiple of the alignment
+    void* p = std::aligned_alloc(alignment, ((size + alignment - 1) / alignment) * alignment);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+}
+
+bool installCryptoAllocHooks() {
+    return CRYPTO_set_mem_functions(countingMalloc, countingRealloc, countingFree) == 1;
+}
+
+void setAllocCounting(bool enabled) {
+    g_counting.store(enabled, std::memory_order_relaxed);
+}
+
+void resetAllocCounters() {
+    t_counters = AllocCounters{};
+}
+
+AllocCounters allocCounters() {
+    return t_counters;
+}
+
+// replaced global allocation functions (all memory comes from malloc, so the library's
+// default operator delete would also match; they are replaced for symmetry)
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, std::align_val_t align) { return allocateAlignedOrThrow(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return allocateAlignedOrThrow(size, align); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
@@ -1,30 +1,22 @@
 #include "crypto_utils.hpp"
+#include "alloc_audit.hpp"
+#include "bench_common.hpp"
+#include "bench_modes.hpp"
+#include "bench_options.hpp"
+#include "dataset_registry.hpp"
+#include "mem_utils.hpp"
+#include "providers.hpp"
 #include <iostream>
 #include <fstream>
 #include <chrono>
 #include <vector>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <cerrno>
 #include <stdexcept>
 #include <iomanip>
 #include <cmath>
+#include <future>
+#include <memory>
 
 
-// simple POSIX helpers for path existence and directory creation
-static bool pathExists(const std::string& p) {
-    struct stat sb{};
-    return ::stat(p.c_str(), &sb) == 0;
-}
-
-static void ensureDir(const std::string& dir) {
-    if (!pathExists(dir)) {
-        if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
-            throw std::runtime_error("Failed to create directory: " + dir);
-        }
-    }
-}
-
 // structure to hold benchmark results
 struct BenchmarkResult {
     std::string cipher;
@@ -35,6 +27,7 @@ struct BenchmarkResult {
     double stddevMs;   // standard deviation in milliseconds
     double throughputMBps; // throughput in MB/s (MB = 1e6 bytes)
     int runs; // number of timed runs
+    CellResources resources; // peak RSS, page faults and context switches of the timed runs
 };
 
 // function to create test files
@@ -103,10 +96,17 @@ std::vector<unsigned char> readFile(const std::string& filename) {
     return buffer;
 }
 
+// one benchmark input: a test file or an in-memory generated dataset
+struct TestInput {
+    std::string name;
+    ByteSpan data;
+    bool onDisk; // only files can be dropped from the page cache
+};
+
 // function to perform benchmark
 double benchmarkEncryption(
     CipherType cipher,
-    const std::vector<unsigned char>& plaintext,
+    ByteSpan plaintext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 ) {
@@ -119,7 +119,7 @@ double benchmarkEncryption(
 // function to benchmark decryption
 double benchmarkDecryption(
     CipherType cipher,
-    const std::vector<unsigned char>& ciphertext,
+    ByteSpan ciphertext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 ) {
@@ -128,6 +128,85 @@ double benchmarkDecryption(
     return timeMs;
 }
 
+// --verify=digest: recovered plaintexts are hashed on a helper thread (one at a time) and
+// compared with the digest of the original, so no recovered copy outlives its check
+class DigestVerifier {
+public:
+    DigestVerifier(ByteSpan original, const std::string& digestName)
+        : digestName_(digestName), expected_(digestBytes(original, digestName)) {}
+
+    ~DigestVerifier() {
+        if (pending_.valid()) {
+            pending_.wait();
+        }
+    }
+
+    // take ownership of a recovered plaintext; waits for the previous check first
+    void submit(ByteBuffer recovered) {
+        collect();
+        pending_ = std::async(std::launch::async, [this, data = std::move(recovered)] {
+            return digestBytes(data, digestName_) == expected_;
+        });
+    }
+
+    // wait for the outstanding check; false if any submitted plaintext did not match
+    bool collect() {
+        if (pending_.valid() && !pending_.get()) {
+            ok_ = false;
+        }
+        return ok_;
+    }
+
+private:
+    std::string digestName_;
+    std::vector<unsigned char> expected_;
+    std::future<bool> pending_;
+    bool ok_ = true;
+};
+
+// signature shared by encrypt_into_with_timing and decrypt_into_with_timing
+using TimedIntoFn = std::pair<size_t, double> (*)(
+    CipherType, const unsigned char*, size_t, unsigned char*,
+    const std::vector<unsigned char>&, const std::vector<unsigned char>&);
+
+// timed runs that start from cold CPU caches: FLUSH clflushes one input/output pair before
+// every sample, ROTATE walks through slots spanning twice the LLC so no sample finds its data cached.
+// The output of the last run is returned through `lastOutput`.
+static std::vector<double> timeColdRuns(
+    TimedIntoFn fn,
+    CpuCacheMode mode,
+    const BufferLayout& layout,
+    int iters,
+    CipherType cipher,
+    ByteSpan input,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv,
+    ByteBuffer& lastOutput
+) {
+    const size_t outputSize = input.size() + cipherBlockSize(cipher);
+    const size_t ringBytes = mode == CpuCacheMode::ROTATE ? 2 * lastLevelCacheSize() : 0;
+    BufferRing ring(input.size(), outputSize, ringBytes, layout);
+    ring.fillInputs(input.data(), input.size());
+
+    std::vector<double> times;
+    times.reserve(iters);
+    size_t slot = 0;
+    size_t outLen = 0;
+    for (int i = 0; i < iters; ++i) {
+        // slot 0 was filled first, so it is the least recently touched one
+        slot = static_cast<size_t>(i) % ring.slots();
+        if (mode == CpuCacheMode::FLUSH) {
+            flushCacheLines(ring.input(slot), ring.inputSize());
+            flushCacheLines(ring.output(slot), ring.outputSize());
+        }
+        auto [len, t] = fn(cipher, ring.input(slot), input.size(), ring.output(slot), key, iv);
+        times.push_back(t);
+        outLen = len;
+    }
+    lastOutput.assign(ring.output(slot), ring.output(slot) + outLen);
+    return times;
+}
+
 // function to save results to CSV
 void saveResultsToCSV(const std::vector<BenchmarkResult>& results) {
     const std::string resultsDir = "results";
@@ -146,7 +225,8 @@ void saveResultsToCSV(const std::vector<BenchmarkResult>& results) {
     }
 
     // write header
-    out << "Cipher,Operation,Filename,FileSize(Bytes),Runs,MeanTime(ms),StdDev(ms),Throughput(MB/s)\n";
+    out << "Cipher,Operation,Filename,FileSize(Bytes),Runs,MeanTime(ms),StdDev(ms),Throughput(MB/s)"
+        << kResourceCsvHeader << "\n";
 
     // write results
     for (const auto& result : results) {
@@ -157,7 +237,9 @@ void saveResultsToCSV(const std::vector<BenchmarkResult>& results) {
             << result.runs << ","
             << std::fixed << std::setprecision(6) << result.meanTimeMs << ","
             << std::fixed << std::setprecision(6) << result.stddevMs << ","
-            << std::fixed << std::setprecision(2) << result.throughputMBps << "\n";
+            << std::fixed << std::setprecision(2) << result.throughputMBps;
+        writeResourceCsv(out, result.resources);
+        out << "\n";
     }
 
     out.close();
@@ -165,104 +247,262 @@ void saveResultsToCSV(const std::vector<BenchmarkResult>& results) {
 
 }
 
-int main() {
-    std::cout << "======================================" << std::endl;
-    std::cout << "      OpenSSL Cipher Benchmark      " << std::endl;
-    std::cout << "======================================" << std::endl;
-
-    try {
-        // step 1: create test files
-        std::cout << "Creating test files..." << std::endl;
-        createTestFiles();
-
-        // step 2: generate key & IV (generated once, reused for all tests)
-        std::cout << "Generating random key and IV..." << std::endl;
-        auto key = generateRandomBytes(16); // 128-bit key
-        auto iv = generateRandomBytes(16);  // 128-bit IV
-        // step 3: define test files
-        std::vector<std::string> testFiles = {
-            "data/file_16B.txt",
-            "data/file_20KB.txt",
-            "data/file_2_5MB.bin"
-        };
-
-        // step 4: define ciphers to test
-        std::vector<CipherType> ciphers = {
-            CipherType::AES,
-            CipherType::CAMELLIA,
-            CipherType::SM4
-        };
-        // step 5: perform benchmarks
-        std::vector<BenchmarkResult> results;
-
-        // repeat configuration
-        const int warmupIters = 1; // one warm-up per (cipher, file)
-        const int timedIters = 5; // number of timed runs
-
-        for (const auto& cipher : ciphers) {
-            std::string cipherName = cipherTypeToString(cipher);
-            std::cout << "\n--- Testing " << cipherName << " ---" << std::endl;
-
-            for (const auto& filename : testFiles) {
-                std::cout << "\nFile: " << filename << std::endl;
-
-                // read file
-                auto plaintext = readFile(filename);
-                size_t fileSize = plaintext.size();
-                std::cout << "File size: " << fileSize << " bytes" << std::endl;
-
-                // warm-up encryption/decryption (not timed)
-                {
-                    auto [ct_warm, _] = encrypt_with_timing(cipher, plaintext, key, iv);
-                    auto [pt_warm, __] = decrypt_with_timing(cipher, ct_warm, key, iv);
-                    if (pt_warm != plaintext) {
-                        throw std::runtime_error("Warm-up decrypt mismatch: plaintext mismatch for " + filename + " with cipher " + cipherName);
-                    }
+// default mode: encrypt/decrypt timings for each (cipher, test file) pair
+static void runSuite(const BenchOptions& opts) {
+    std::cout << "CPU cache mode: " << cpuCacheModeToString(opts.cpuCache)
+              << (opts.coldPageCache ? ", cold page cache" : "") << std::endl;
+
+    // step 1: create test files
+    std::cout << "Creating test files..." << std::endl;
+    createTestFiles();
+
+    // step 2: generate key & IV (generated once, reused for all tests)
+    std::cout << "Generating random key and IV..." << std::endl;
+    auto key = generateRandomBytes(16); // 128-bit key
+    auto iv = generateRandomBytes(16);  // 128-bit IV
+    // step 3: define test files, plus generated datasets for --sizes
+    std::vector<std::string> testFiles = {
+        "data/file_16B.txt",
+        "data/file_20KB.txt",
+        "data/file_2_5MB.bin"
+    };
+
+    // load every dataset once; all ciphers share these read-only views
+    DatasetRegistry datasets;
+    std::vector<TestInput> inputs;
+    for (const auto& filename : testFiles) {
+        inputs.push_back({filename, datasets.load(filename), true});
+    }
+    for (size_t size : opts.datasetSizes) {
+        // exact byte count: formatBytes rounds, so distinct sizes could share a name
+        std::string name = "generated/" + std::to_string(size) + "B";
+        auto data = datasets.generate(name, size, [](unsigned char* buf, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                buf[i] = static_cast<unsigned char>('a' + (i % 26));
+            }
+        });
+        inputs.push_back({name, data, false});
+    }
+    std::cout << "Loaded " << inputs.size() << " datasets (" << formatBytes(datasets.totalBytes()) << ")" << std::endl;
+
+    // step 4: ciphers to test (all three unless --ciphers narrows it down)
+    const std::vector<CipherType>& ciphers = opts.ciphers;
+    // step 5: perform benchmarks
+    std::vector<BenchmarkResult> results;
+
+    // repeat configuration
+    const int warmupIters = 1; // one warm-up per (cipher, file)
+    const int timedIters = opts.timedIters; // number of timed runs
+
+    for (const auto& cipher : ciphers) {
+        std::string cipherName = cipherTypeToString(cipher);
+        std::cout << "\n--- Testing " << cipherName << " ---" << std::endl;
+
+        for (const auto& input : inputs) {
+            const std::string& filename = input.name;
+            std::cout << "\nFile: " << filename << std::endl;
+
+            ByteSpan plaintext = input.data;
+            size_t fileSize = plaintext.size();
+            std::cout << "File size: " << fileSize << " bytes" << std::endl;
+
+            // warm-up encryption/decryption (not timed)
+            {
+                auto [ct_warm, _] = encrypt_with_timing(cipher, plaintext, key, iv);
+                auto [pt_warm, __] = decrypt_with_timing(cipher, ct_warm, key, iv);
+                if (pt_warm != plaintext) {
+                    throw std::runtime_error("Warm-up decrypt mismatch: plaintext mismatch for " + filename + " with cipher " + cipherName);
                 }
+            }
 
-                // timed runs: encryption
-                std::vector<double> encTimes;
-                encTimes.reserve(timedIters);
-                std::vector<unsigned char> ciphertext_last;
+            // timed runs: encryption
+            std::vector<double> encTimes;
+            encTimes.reserve(timedIters);
+            ByteBuffer ciphertext_last;
+            ResourceMeter encMeter;
+            if (opts.cpuCache == CpuCacheMode::WARM) {
                 for (int i = 0; i < timedIters; ++i) {
                     auto [ct, t] = encrypt_with_timing(cipher, plaintext, key, iv);
                     encTimes.push_back(t);
                     ciphertext_last = std::move(ct);
                 }
-                // compute mean and stddev for encryption
-                double encSum = 0.0; for (double v : encTimes) encSum += v;
-                double encMean = encSum / encTimes.size();
-                double encVar = 0.0; for (double v : encTimes) encVar += (v - encMean) * (v - encMean); encVar /= encTimes.size();
-                double encStd = std::sqrt(encVar);
-                double encThroughputMBs = (fileSize / 1.0e6) / (encMean / 1000.0); // MB/s using MB=1e6 bytes
-                std::cout << "Encrypt: mean=" << std::fixed << std::setprecision(6) << encMean << " ms, stddev=" << encStd
-                          << " ms, throughput=" << std::setprecision(2) << encThroughputMBs << " MB/s" << std::endl;
-                results.push_back({cipherName, "encrypt", filename, fileSize, encMean, encStd, encThroughputMBs, timedIters});
-
-                // timed runs: decryption on last ciphertext
-                std::vector<double> decTimes;
-                decTimes.reserve(timedIters);
-                std::vector<unsigned char> plaintext_last;
+            } else {
+                encTimes = timeColdRuns(encrypt_into_with_timing, opts.cpuCache, opts.layout, timedIters,
+                                        cipher, plaintext, key, iv, ciphertext_last);
+            }
+            CellResources encResources = encMeter.finish();
+            // compute mean and stddev for encryption
+            auto [encMean, encStd] = meanAndStddev(encTimes);
+            double encThroughputMBs = (fileSize / 1.0e6) / (encMean / 1000.0); // MB/s using MB=1e6 bytes
+            std::cout << "Encrypt: mean=" << std::fixed << std::setprecision(6) << encMean << " ms, stddev=" << encStd
+                      << " ms, throughput=" << std::setprecision(2) << encThroughputMBs << " MB/s" << std::endl;
+            std::cout << "         " << formatResources(encResources) << std::endl;
+            results.push_back({cipherName, "encrypt", filename, fileSize, encMean, encStd, encThroughputMBs, timedIters, encResources});
+
+            // timed runs: decryption on last ciphertext
+            std::vector<double> decTimes;
+            decTimes.reserve(timedIters);
+            ByteBuffer plaintext_last;
+            std::unique_ptr<DigestVerifier> verifier;
+            if (opts.verify == VerifyMode::DIGEST) {
+                verifier = std::make_unique<DigestVerifier>(plaintext, opts.digestName);
+            }
+            ResourceMeter decMeter;
+            if (opts.cpuCache == CpuCacheMode::WARM) {
                 for (int i = 0; i < timedIters; ++i) {
                     auto [pt, t] = decrypt_with_timing(cipher, ciphertext_last, key, iv);
                     decTimes.push_back(t);
-                    plaintext_last = std::move(pt);
+                    if (verifier) {
+                        verifier->submit(std::move(pt)); // every run is checked, none is kept
+                    } else {
+                        plaintext_last = std::move(pt);
+                    }
+                }
+            } else {
+                decTimes = timeColdRuns(decrypt_into_with_timing, opts.cpuCache, opts.layout, timedIters,
+                                        cipher, ciphertext_last, key, iv, plaintext_last);
+                if (verifier) {
+                    verifier->submit(std::move(plaintext_last));
                 }
-                if (plaintext_last != plaintext) {
-                    throw std::runtime_error("Decryption mismatch: recovered plaintext differs for " + filename + " with cipher " + cipherName);
+            }
+            bool recovered = verifier ? verifier->collect() : plaintext_last == plaintext;
+            CellResources decResources = decMeter.finish();
+            if (!recovered) {
+                throw std::runtime_error("Decryption mismatch: recovered plaintext differs for " + filename + " with cipher " + cipherName);
+            }
+            auto [decMean, decStd] = meanAndStddev(decTimes);
+            double decThroughputMBs = (fileSize / 1.0e6) / (decMean / 1000.0);
+            std::cout << "Decrypt: mean=" << std::fixed << std::setprecision(6) << decMean << " ms, stddev=" << decStd
+                      << " ms, throughput=" << std::setprecision(2) << decThroughputMBs << " MB/s" << std::endl;
+            std::cout << "         " << formatResources(decResources) << std::endl;
+            results.push_back({cipherName, "decrypt", filename, fileSize, decMean, decStd, decThroughputMBs, timedIters, decResources});
+
+            // cold page cache: time reading the file back from storage plus encrypting it
+            if (opts.coldPageCache && input.onDisk) {
+                std::vector<double> ioTimes;
+                ioTimes.reserve(timedIters);
+                ResourceMeter ioMeter;
+                for (int i = 0; i < timedIters; ++i) {
+                    dropFilePageCache(filename);
+                    auto t0 = std::chrono::steady_clock::now();
+                    auto data = readFile(filename);
+                    auto ct = encrypt(cipher, data, key, iv);
+                    auto t1 = std::chrono::steady_clock::now();
+                    ioTimes.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
                 }
-                double decSum = 0.0; for (double v : decTimes) decSum += v;
-                double decMean = decSum / decTimes.size();
-                double decVar = 0.0; for (double v : decTimes) decVar += (v - decMean) * (v - decMean); decVar /= decTimes.size();
-                double decStd = std::sqrt(decVar);
-                double decThroughputMBs = (fileSize / 1.0e6) / (decMean / 1000.0);
-                std::cout << "Decrypt: mean=" << std::fixed << std::setprecision(6) << decMean << " ms, stddev=" << decStd
-                          << " ms, throughput=" << std::setprecision(2) << decThroughputMBs << " MB/s" << std::endl;
-                results.push_back({cipherName, "decrypt", filename, fileSize, decMean, decStd, decThroughputMBs, timedIters});
+                auto [ioMean, ioStd] = meanAndStddev(ioTimes);
+                double ioThroughputMBs = (fileSize / 1.0e6) / (ioMean / 1000.0);
+                std::cout << "Cold read+encrypt: mean=" << std::fixed << std::setprecision(6) << ioMean << " ms, stddev=" << ioStd
+                          << " ms, throughput=" << std::setprecision(2) << ioThroughputMBs << " MB/s" << std::endl;
+                results.push_back({cipherName, "read+encrypt", filename, fileSize, ioMean, ioStd, ioThroughputMBs, timedIters,
+                                   ioMeter.finish()});
             }
         }
-        // step 6: save results to CSV
-        saveResultsToCSV(results);
+    }
+    // step 6: save results to CSV
+    saveResultsToCSV(results);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    try {
+        opts = parseArgs(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (opts.showHelp) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    // the OpenSSL allocator can only be swapped before its first allocation
+    if (opts.mode == BenchMode::ALLOC && !installCryptoAllocHooks()) {
+        std::cerr << "Warning: could not install OpenSSL allocation hooks, OpenSSL counts will be zero" << std::endl;
+    }
+
+    std::cout << "======================================" << std::endl;
+    std::cout << "      OpenSSL Cipher Benchmark      " << std::endl;
+    std::cout << "======================================" << std::endl;
+
+    try {
+        if (!opts.providers.empty() || !opts.cipherProperties.empty()) {
+            const ProviderConfig config{"command line", opts.providers, opts.cipherProperties};
+            applyProviderConfig(config);
+            std::cout << "Providers: " << describeProviderConfig(config) << std::endl;
+        }
+        if (opts.mode != BenchMode::SUITE) {
+            std::cout << "Mode: " << benchModeToString(opts.mode) << std::endl;
+        }
+        switch (opts.mode) {
+            case BenchMode::WSS:
+                runWorkingSetSweep(opts);
+                break;
+            case BenchMode::ROOFLINE:
+                runRoofline(opts);
+                break;
+            case BenchMode::ALIGNMENT:
+                runAlignmentSweep(opts);
+                break;
+            case BenchMode::NUMA:
+                runNumaBenchmark(opts);
+                break;
+            case BenchMode::STREAM:
+                runStreamVerify(opts);
+                break;
+            case BenchMode::ALLOC:
+                runAllocationAudit(opts);
+                break;
+            case BenchMode::ZEROFILL:
+                runZeroFillCost(opts);
+                break;
+            case BenchMode::INPLACE:
+                runInPlaceBenchmark(opts);
+                break;
+            case BenchMode::GATHER:
+                runGatherBenchmark(opts);
+                break;
+            case BenchMode::BATCH:
+                runBatchBenchmark(opts);
+                break;
+            case BenchMode::MULTISTREAM:
+                runMultiStreamBenchmark(opts);
+                break;
+            case BenchMode::KERNELS:
+                runKernelComparison(opts);
+                break;
+            case BenchMode::BACKENDS:
+                runBackendComparison(opts);
+                break;
+            case BenchMode::FETCH:
+                runFetchBenchmark(opts);
+                break;
+            case BenchMode::CONTENTION:
+                runInitContention(opts);
+                break;
+            case BenchMode::PROVIDERS:
+                runProviderMatrix(opts);
+                break;
+            case BenchMode::LIBS:
+                runLibraryComparison(opts);
+                break;
+            case BenchMode::SESSION:
+                runSessionBenchmark(opts);
+                break;
+            case BenchMode::TENANTS:
+                runTenantWorkload(opts);
+                break;
+            case BenchMode::REPLAY:
+                runTraceReplay(opts);
+                break;
+            case BenchMode::IMIX:
+                runPacketMix(opts);
+                break;
+            case BenchMode::SUITE:
+            default:
+                runSuite(opts);
+                break;
+        }
 
         std::cout << "\n======================================" << std::endl;
         std::cout << "        Benchmark Completed         " << std::endl;
@@ -272,4 +512,4 @@ int main() {
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+// plaintext bytes encrypted per timed sample; the ring is walked with a persistent cursor
+const size_t kBytesPerSample = 8 * 1024 * 1024;
+
+// (input, output) offsets past a cache-line boundary: aligned, byte-misaligned on either
+// side, both, and 8-byte aligned but not 16-byte aligned
+std::vector<std::pair<size_t, size_t>> offsetPairs(const BufferLayout& requested) {
+    std::vector<std::pair<size_t, size_t>> pairs = {{0, 0}, {1, 0}, {0, 1}, {1, 1}, {8, 8}};
+    std::pair<size_t, size_t> user{requested.inputOffset, requested.outputOffset};
+    if (std::find(pairs.begin(), pairs.end(), user) == pairs.end()) {
+        pairs.push_back(user);
+    }
+    return pairs;
+}
+}
+
+void runAlignmentSweep(const BenchOptions& opts) {
+    const size_t messageSize = opts.messageSize;
+    // twice the LLC spans far more pages than the TLBs cover, so page size matters
+    const size_t ringBytes = 2 * lastLevelCacheSize();
+    const size_t messagesPerSample = std::max<size_t>(1, kBytesPerSample / messageSize);
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+    const auto message = generateRandomBytes(messageSize);
+    const auto pairs = offsetPairs(opts.layout);
+
+    std::cout << "Working set " << formatBytes(ringBytes) << ", " << messageSize << " B messages" << std::endl;
+
+    auto csv = openResultsFile("alignment_results.csv");
+    csv << "Cipher,PageSize,InputOffset,OutputOffset,MessageSize(Bytes),Runs,Throughput(MB/s),StdDev(MB/s),RelativeToBaseline\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t outputSize = messageSize + cipherBlockSize(cipher);
+        std::cout << "\n--- Alignment sweep: " << cipherName << " ---" << std::endl;
+        std::cout << std::left << std::setw(7) << "Pages" << std::setw(9) << "InOff" << std::setw(9) << "OutOff"
+                  << std::setw(22) << "Throughput (MB/s)" << "vs base/0/0" << std::right << std::endl;
+
+        double baseline = 0.0;
+        for (PageSize pages : {PageSize::BASE, PageSize::THP, PageSize::HUGE_2MB, PageSize::HUGE_1GB}) {
+            for (auto [inOff, outOff] : pairs) {
+                // the rest of --page-size/--mem-node/... as given, with this cell's pages and offsets
+                BufferLayout layout = opts.layout;
+                layout.pageSize = pages;
+                layout.inputOffset = inOff;
+                layout.outputOffset = outOff;
+                std::unique_ptr<BufferRing> ring;
+                try {
+                    ring = std::make_unique<BufferRing>(messageSize, outputSize, ringBytes, layout);
+                } catch (const std::runtime_error& ex) {
+                    std::cout << std::left << std::setw(7) << pageSizeToString(pages) << std::right
+                              << "unavailable: " << ex.what() << std::endl;
+                    break; // the other offsets would fail the same way
+                }
+                ring->fillInputs(message.data(), message.size());
+
+                size_t cursor = 0;
+                auto sample = [&]() {
+                    auto t0 = std::chrono::steady_clock::now();
+                    for (size_t m = 0; m < messagesPerSample; ++m, ++cursor) {
+                        encrypt_into_with_timing(cipher, ring->input(cursor), messageSize, ring->output(cursor), key, iv);
+                    }
+                    auto t1 = std::chrono::steady_clock::now();
+                    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+                    return (static_cast<double>(messagesPerSample) * messageSize / 1.0e6) / (ms / 1000.0);
+                };
+                sample(); // warm-up
+
+                std::vector<double> throughputs;
+                for (int i = 0; i < opts.timedIters; ++i) {
+                    throughputs.push_back(sample());
+                }
+                auto [mean, stddev] = meanAndStddev(throughputs);
+                if (baseline == 0.0) {
+                    baseline = mean; // first cell is base pages, aligned buffers
+                }
+
+                std::cout << std::left << std::setw(7) << pageSizeToString(pages) << std::setw(9) << inOff
+                          << std::setw(9) << outOff << std::right << std::fixed << std::setprecision(2)
+                          << std::setw(9) << mean << " +/- " << std::setw(7) << stddev << "    "
+                          << std::setprecision(3) << mean / baseline << std::endl;
+                csv << cipherName << "," << pageSizeToString(pages) << "," << inOff << "," << outOff << ","
+                    << messageSize << "," << opts.timedIters << "," << std::fixed << std::setprecision(2)
+                    << mean << "," << stddev << "," << std::setprecision(3) << mean / baseline << "\n";
+            }
+        }
+    }
+    std::cout << "\nSaved alignment sweep results to: results/alignment_results.csv" << std::endl;
+}
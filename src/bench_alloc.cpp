@@ -0,0 +1,178 @@
+#include "bench_modes.hpp"
+#include "alloc_audit.hpp"
+#include "bench_common.hpp"
+#include "cipher_cache.hpp"
+#include "crypto_utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// calls per variant before and during the audit; warm-up absorbs one-time setup such as
+// OpenSSL's first implicit cipher fetch
+const int kWarmupCalls = 3;
+const int kAuditCalls = 100;
+
+// one entry point of crypto_utils exercised by the audit
+struct ApiVariant {
+    std::string name;
+    bool allocationFree; // designed to be allocation-free in steady state (enforced by --strict-alloc)
+    std::function<void()> call;
+};
+}
+
+void runAllocationAudit(const BenchOptions& opts) {
+    const size_t messageSize = opts.messageSize;
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+    const auto message = generateRandomBytes(messageSize);
+
+    auto csv = openResultsFile("alloc_results.csv");
+    csv << "Cipher,Variant,MessageSize(Bytes),Calls,CryptoAllocsPerOp,CryptoBytesPerOp,CxxAllocsPerOp,CxxBytesPerOp,"
+           "ExpectedAllocationFree,Status\n";
+
+    std::vector<std::string> violations;
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t block = cipherBlockSize(cipher);
+        const auto ciphertext = encrypt(cipher, message, key, iv);
+        std::vector<unsigned char> out(ciphertext.size() + block);
+        std::vector<unsigned char> inPlace(paddedLength(cipher, messageSize));
+        // whole blocks for the streaming variants, so they never hold back a partial block
+        const ByteSpan blocks(message.data(), (messageSize / block) * block);
+        // header + two body slices, split off block boundaries so partial blocks carry over
+        auto split = [](ByteSpan whole) {
+            const size_t head = std::min<size_t>(13, whole.size() / 2);
+            return std::vector<ByteSpan>{
+                {whole.data(), head},
+                {whole.data() + head, whole.size() / 2 - head},
+                {whole.data() + whole.size() / 2, whole.size() - whole.size() / 2},
+            };
+        };
+        const std::vector<ByteSpan> fragments = split(message);
+        const std::vector<ByteSpan> cipherFragments = split(ciphertext);
+        // a batch of one message: the per-batch cost is the context, shared by every message
+        std::vector<BatchItem> batch(1);
+        batch[0].input = message;
+        batch[0].iv = iv.data();
+        batch[0].out = out.data();
+        std::vector<BatchItem> decryptBatch(1);
+        decryptBatch[0].input = ciphertext;
+        decryptBatch[0].iv = iv.data();
+        decryptBatch[0].out = out.data();
+        const std::string evpName = evpCipherName(cipher);
+        const evp_cipher_st* fetched = evpCipher(cipher);
+        ByteBuffer buffer;
+        CipherStream encryptStream(cipher, true, key, iv);
+        CipherStream decryptStream(cipher, false, key, iv);
+        CipherSession encryptSession(cipher, true, key);
+        CipherSession decryptSession(cipher, false, key);
+
+        std::vector<ApiVariant> variants = {
+            {"encrypt", false, [&] { encrypt(cipher, message, key, iv); }},
+            {"decrypt", false, [&] { decrypt(cipher, ciphertext, key, iv); }},
+            {"encrypt_with_timing", false, [&] { encrypt_with_timing(cipher, message, key, iv); }},
+            {"decrypt_with_timing", false, [&] { decrypt_with_timing(cipher, ciphertext, key, iv); }},
+            {"encrypt_into_with_timing", false, [&] {
+                encrypt_into_with_timing(cipher, message.data(), messageSize, out.data(), key, iv);
+            }},
+            {"decrypt_into_with_timing", false, [&] {
+                decrypt_into_with_timing(cipher, ciphertext.data(), ciphertext.size(), out.data(), key, iv);
+            }},
+            {"encrypt_in_place_with_timing", false, [&] {
+                encrypt_in_place_with_timing(cipher, inPlace.data(), messageSize, inPlace.size(), key, iv);
+            }},
+            {"decrypt_in_place_with_timing", false, [&] {
+                // the previous call overwrote the ciphertext, so restore it first
+                std::memcpy(inPlace.data(), ciphertext.data(), ciphertext.size());
+                decrypt_in_place_with_timing(cipher, inPlace.data(), ciphertext.size(), key, iv);
+            }},
+            {"encrypt_in_place", false, [&] {
+                buffer.assign(message.begin(), message.end());
+                encrypt_in_place(cipher, buffer, key, iv);
+            }},
+            {"decrypt_in_place", false, [&] {
+                buffer.assign(ciphertext.begin(), ciphertext.end());
+                decrypt_in_place(cipher, buffer, key, iv);
+            }},
+            {"evp_encrypt_into_with_timing(name)", false, [&] {
+                evp_encrypt_into_with_timing(evpName, message.data(), messageSize, out.data(), key, iv);
+            }},
+            {"evp_decrypt_into_with_timing(name)", false, [&] {
+                evp_decrypt_into_with_timing(evpName, ciphertext.data(), ciphertext.size(), out.data(), key, iv);
+            }},
+            {"evp_encrypt_into_with_timing(EVP)", false, [&] {
+                evp_encrypt_into_with_timing(fetched, message.data(), messageSize, out.data(), key, iv);
+            }},
+            {"evp_decrypt_into_with_timing(EVP)", false, [&] {
+                evp_decrypt_into_with_timing(fetched, ciphertext.data(), ciphertext.size(), out.data(), key, iv);
+            }},
+            {"encrypt_gather", false, [&] { encrypt_gather(cipher, fragments, out.data(), key, iv); }},
+            {"decrypt_gather", false, [&] { decrypt_gather(cipher, cipherFragments, out.data(), key, iv); }},
+            {"encrypt_gather (new buffer)", false, [&] { encrypt_gather(cipher, fragments, key, iv); }},
+            {"decrypt_gather (new buffer)", false, [&] { decrypt_gather(cipher, cipherFragments, key, iv); }},
+            {"encrypt_batch (1 message)", false, [&] { encrypt_batch(cipher, batch, key); }},
+            {"decrypt_batch (1 message)", false, [&] { decrypt_batch(cipher, decryptBatch, key); }},
+            {"CipherStream::update(encrypt)", true, [&] { encryptStream.update(blocks, out.data()); }},
+            {"CipherStream::update(decrypt)", true, [&] { decryptStream.update(blocks, out.data()); }},
+            {"CipherSession::process(enc)", true, [&] { encryptSession.process(message, iv.data(), out.data()); }},
+            {"CipherSession::process(dec)", true, [&] { decryptSession.process(ciphertext, iv.data(), out.data()); }},
+            {"CipherSession::process_with_timing(enc)", true, [&] {
+                encryptSession.process_with_timing(message, iv.data(), out.data());
+            }},
+            {"CipherSession::process_with_timing(dec)", true, [&] {
+                decryptSession.process_with_timing(ciphertext, iv.data(), out.data());
+            }},
+        };
+
+        std::cout << "\n--- Allocation audit: " << cipherName << ", " << messageSize << " B messages ---" << std::endl;
+        std::cout << std::left << std::setw(42) << "Variant" << std::setw(22) << "OpenSSL allocs/op"
+                  << std::setw(22) << "C++ allocs/op" << "Status" << std::right << std::endl;
+
+        for (const auto& variant : variants) {
+            for (int i = 0; i < kWarmupCalls; ++i) {
+                variant.call();
+            }
+            resetAllocCounters();
+            setAllocCounting(true);
+            for (int i = 0; i < kAuditCalls; ++i) {
+                variant.call();
+            }
+            setAllocCounting(false);
+            AllocCounters c = allocCounters();
+
+            const bool allocates = c.cryptoAllocs != 0 || c.cxxAllocs != 0;
+            const char* status = !allocates ? "allocation-free" : (variant.allocationFree ? "VIOLATION" : "allocates");
+            if (allocates && variant.allocationFree) {
+                violations.push_back(cipherName + " " + variant.name);
+            }
+            auto perOp = [](uint64_t v) { return static_cast<double>(v) / kAuditCalls; };
+            std::ostringstream crypto, cxx;
+            crypto << std::fixed << std::setprecision(2) << perOp(c.cryptoAllocs) << " (" << perOp(c.cryptoBytes) << " B)";
+            cxx << std::fixed << std::setprecision(2) << perOp(c.cxxAllocs) << " (" << perOp(c.cxxBytes) << " B)";
+            std::cout << std::left << std::setw(42) << variant.name << std::setw(22) << crypto.str()
+                      << std::setw(22) << cxx.str() << status << std::right << std::endl;
+            csv << cipherName << "," << variant.name << "," << messageSize << "," << kAuditCalls << ","
+                << std::fixed << std::setprecision(2) << perOp(c.cryptoAllocs) << "," << perOp(c.cryptoBytes) << ","
+                << perOp(c.cxxAllocs) << "," << perOp(c.cxxBytes) << ","
+                << (variant.allocationFree ? "yes" : "no") << "," << status << "\n";
+        }
+    }
+    std::cout << "\nSaved allocation audit to: results/alloc_results.csv" << std::endl;
+
+    if (!violations.empty()) {
+        std::string list;
+        for (const auto& v : violations) {
+            list += (list.empty() ? "" : ", ") + v;
+        }
+        if (opts.strictAlloc) {
+            throw std::runtime_error("Steady-state allocations in allocation-free variants: " + list);
+        }
+        std::cout << "Warning: steady-state allocations in allocation-free variants: " << list << std::endl;
+    }
+}
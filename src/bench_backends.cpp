@@ -0,0 +1,181 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_backend.hpp"
+#include "crypto_utils.hpp"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// message sizes compared when --sizes is not given: small ones expose the per-call API overhead
+const std::vector<size_t> kDefaultSizes = {16, 64, 256, 1024, 16 * 1024, 1024 * 1024};
+
+// plaintext bytes processed per timed sample
+const size_t kBytesPerSample = 4 * 1024 * 1024;
+
+// one cell of the report
+struct CallCost {
+    double ns;              // mean time per call
+    double stddev;          // standard deviation of the per-sample means
+    double syscallsPerCall; // system calls issued by the backend per call
+    double systemShare;     // fraction of the process CPU time spent in the kernel
+};
+
+double cpuSeconds(const timeval& tv) {
+    return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1.0e6;
+}
+
+// warm up once, then `iters` samples of `reps` calls of `op` on `backend`
+CallCost sampleCall(CryptoBackend& backend, int iters, size_t reps, const std::function<double()>& op) {
+    op();
+    const uint64_t syscallsBefore = backend.syscalls();
+    struct rusage before{};
+    ::getrusage(RUSAGE_SELF, &before);
+    std::vector<double> nsPerCall;
+    for (int i = 0; i < iters; ++i) {
+        double ms = 0.0;
+        for (size_t r = 0; r < reps; ++r) {
+            ms += op();
+        }
+        nsPerCall.push_back(ms * 1.0e6 / static_cast<double>(reps));
+    }
+    struct rusage after{};
+    ::getrusage(RUSAGE_SELF, &after);
+    const double user = cpuSeconds(after.ru_utime) - cpuSeconds(before.ru_utime);
+    const double system = cpuSeconds(after.ru_stime) - cpuSeconds(before.ru_stime);
+    auto [ns, stddev] = meanAndStddev(nsPerCall);
+    const double calls = static_cast<double>(reps) * iters;
+    return {ns, stddev, static_cast<double>(backend.syscalls() - syscallsBefore) / calls,
+            user + system > 0.0 ? system / (user + system) : 0.0};
+}
+
+// the backend must produce the EVP backend's ciphertext and recover the plaintext, for whole and
+// partial final blocks
+void verifyAgainstEvp(CryptoBackend& evp, CryptoBackend& backend, CipherType cipher, ByteSpan message,
+                      const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv) {
+    const std::string name = backendTypeToString(backend.type()) + " " + cipherTypeToString(cipher);
+    const size_t block = cipherBlockSize(cipher);
+    for (size_t length : {message.size(), message.size() > 5 ? message.size() - 5 : message.size()}) {
+        ByteBuffer expected(length + block);
+        ByteBuffer actual(length + block);
+        ByteBuffer recovered(length + block);
+        const size_t expectedLen = evp.encryptInto(cipher, message.data(), length, expected.data(), key, iv).first;
+        const size_t actualLen = backend.encryptInto(cipher, message.data(), length, actual.data(), key, iv).first;
+        if (ByteSpan(actual.data(), actualLen) != ByteSpan(expected.data(), expectedLen)) {
+            throw std::runtime_error(name + " encryption differs from EVP at " + std::to_string(length) + " bytes");
+        }
+        const size_t recoveredLen = backend.decryptInto(cipher, actual.data(), actualLen, recovered.data(), key, iv).first;
+        if (ByteSpan(recovered.data(), recoveredLen) != ByteSpan(message.data(), length)) {
+            throw std::runtime_error(name + " decryption did not recover the plaintext at "
+                                     + std::to_string(length) + " bytes");
+        }
+    }
+}
+}
+
+void runBackendComparison(const BenchOptions& opts) {
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    std::vector<std::unique_ptr<CryptoBackend>> backends;
+    for (BackendType type : opts.backends.empty() ? allBackendTypes() : opts.backends) {
+        backends.push_back(makeBackend(type));
+    }
+    auto evp = makeBackend(BackendType::EVP);
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+
+    auto csv = openResultsFile("backend_results.csv");
+    csv << "Cipher,Operation,Backend,Size(Bytes),Runs,ns/Op,StdDev(ns),Throughput(MB/s),Syscalls/Op,"
+           "SystemTime(%),vsEVP\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t block = cipherBlockSize(cipher);
+        std::vector<CryptoBackend*> active;
+        for (const auto& backend : backends) {
+            if (backend->supports(cipher)) {
+                active.push_back(backend.get());
+            } else {
+                std::cout << "Skipping " << backendTypeToString(backend->type()) << " for " << cipherName
+                          << ": not available in this build, on this CPU or in this kernel" << std::endl;
+            }
+        }
+        if (active.empty()) {
+            continue;
+        }
+
+        std::cout << "\n--- " << cipherName << "-CBC per backend (ns/op, MB/s) ---" << std::endl;
+        std::cout << std::left << std::setw(10) << "Size" << std::setw(10) << "Op";
+        for (CryptoBackend* backend : active) {
+            std::cout << std::setw(25) << backendTypeToString(backend->type());
+        }
+        std::cout << std::right << std::endl;
+
+        for (size_t size : sizes) {
+            const auto message = generateRandomBytes(size);
+            for (CryptoBackend* backend : active) {
+                verifyAgainstEvp(*evp, *backend, cipher, message, key, iv);
+            }
+            const size_t reps = std::max<size_t>(1, kBytesPerSample / size);
+            ByteBuffer ciphertext(size + block);
+            const size_t ciphertextLen = evp->encryptInto(cipher, message.data(), size, ciphertext.data(), key, iv).first;
+            ByteBuffer out(size + block);
+
+            for (bool encryptOp : {true, false}) {
+                const std::string op = encryptOp ? "encrypt" : "decrypt";
+                std::cout << std::left << std::setw(10) << formatBytes(size) << std::setw(10) << op << std::right;
+                auto run = [&](CryptoBackend& backend) {
+                    return sampleCall(backend, opts.timedIters, reps, [&] {
+                        return encryptOp ? backend.encryptInto(cipher, message.data(), size, out.data(), key, iv).second
+                                         : backend.decryptInto(cipher, ciphertext.data(), ciphertextLen, out.data(), key, iv).second;
+                    });
+                };
+                // the EVP path is the reference for the relative cost of every backend; it is only
+                // measured separately when --backends leaves it out of the table
+                std::vector<CallCost> costs;
+                double evpNs = 0.0;
+                for (CryptoBackend* backend : active) {
+                    costs.push_back(run(*backend));
+                    if (backend->type() == BackendType::EVP) {
+                        evpNs = costs.back().ns;
+                    }
+                }
+                if (evpNs == 0.0) {
+                    evpNs = run(*evp).ns;
+                }
+                std::vector<std::string> syscallNotes;
+                for (size_t b = 0; b < active.size(); ++b) {
+                    CryptoBackend* backend = active[b];
+                    const CallCost& cost = costs[b];
+                    const std::string name = backendTypeToString(backend->type());
+                    const double mbPerSec = size / cost.ns * 1.0e3;
+                    std::cout << std::fixed << std::setprecision(0) << std::setw(10) << cost.ns << " ns "
+                              << std::setprecision(1) << std::setw(8) << mbPerSec << "   ";
+                    csv << cipherName << "," << op << "," << name << "," << size << "," << opts.timedIters << ","
+                        << std::fixed << std::setprecision(1) << cost.ns << "," << cost.stddev << ","
+                        << std::setprecision(2) << mbPerSec << "," << cost.syscallsPerCall << ","
+                        << std::setprecision(1) << cost.systemShare * 100.0 << "," << std::setprecision(2)
+                        << cost.ns / evpNs << "\n";
+                    if (cost.syscallsPerCall > 0.0) {
+                        std::ostringstream note;
+                        note << name << ": " << std::fixed << std::setprecision(1) << cost.syscallsPerCall
+                             << " syscalls/op, " << cost.systemShare * 100.0 << "% system time, "
+                             << std::setprecision(2) << cost.ns / evpNs << "x EVP";
+                        syscallNotes.push_back(note.str());
+                    }
+                }
+                std::cout << std::endl;
+                for (const auto& note : syscallNotes) {
+                    std::cout << "                    " << note << std::endl;
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved backend comparison to: results/backend_results.csv" << std::endl;
+}
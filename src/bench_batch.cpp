@@ -0,0 +1,147 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// small-message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {16, 64, 128, 256, 512, 1024};
+
+// message bytes per timed sample, so that every sample runs long enough to time reliably
+const size_t kBytesPerSample = 4 * 1024 * 1024;
+
+// N messages of one size with their IVs and output slots, each in one contiguous arena
+struct MessageSet {
+    MessageSet(size_t count, size_t size, size_t outputSize)
+        : size(size), outputSize(outputSize),
+          inputs(generateRandomBytes(count * size)), ivs(generateRandomBytes(count * 16)),
+          outputs(count * outputSize) {}
+
+    std::vector<BatchItem> items(ByteSpan in, size_t inSize, size_t inStride) {
+        std::vector<BatchItem> batch(ivs.size() / 16);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].input = ByteSpan(in.data() + i * inStride, inSize);
+            batch[i].iv = ivs.data() + i * 16;
+            batch[i].out = outputs.data() + i * outputSize;
+        }
+        return batch;
+    }
+
+    size_t size;
+    size_t outputSize;
+    std::vector<unsigned char> inputs;
+    std::vector<unsigned char> ivs;
+    ByteBuffer outputs;
+};
+
+// one row of the report
+struct Rate {
+    double opsPerSec;
+    double nsPerMessage;
+    double mbPerSec;
+};
+
+// time `reps` runs of `op`, which processes `messages` messages of `size` bytes, over `iters` samples
+Rate measure(int iters, size_t reps, size_t messages, size_t size, const std::function<void()>& op) {
+    using clock = std::chrono::steady_clock;
+    op(); // warm-up
+    std::vector<double> nsPerMessage;
+    for (int i = 0; i < iters; ++i) {
+        auto t0 = clock::now();
+        for (size_t r = 0; r < reps; ++r) {
+            op();
+        }
+        auto t1 = clock::now();
+        std::chrono::duration<double, std::nano> dt = t1 - t0;
+        nsPerMessage.push_back(dt.count() / static_cast<double>(reps * messages));
+    }
+    const double ns = meanAndStddev(nsPerMessage).first;
+    return {1.0e9 / ns, ns, (size / 1.0e6) * (1.0e9 / ns)};
+}
+}
+
+void runBatchBenchmark(const BenchOptions& opts) {
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const size_t batchSize = static_cast<size_t>(opts.batchSize);
+    const auto key = generateRandomBytes(16);
+
+    auto csv = openResultsFile("batch_results.csv");
+    csv << "Cipher,Operation,Variant,MessageSize(Bytes),BatchSize,Runs,Ops/s,ns/Message,Throughput(MB/s)\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t block = cipherBlockSize(cipher);
+        std::cout << "\n--- Batch API: " << cipherName << ", " << batchSize << " messages per batch ---" << std::endl;
+        std::cout << std::left << std::setw(8) << "Size" << std::setw(10) << "Op"
+                  << std::setw(26) << "per-message (ns/msg)" << std::setw(20) << "batch (ns/msg)"
+                  << std::setw(16) << "batch ops/s" << "speedup" << std::right << std::endl;
+
+        for (size_t size : sizes) {
+            const size_t outputSize = paddedLength(cipher, size);
+            MessageSet set(batchSize, size, outputSize + block);
+            const size_t reps = std::max<size_t>(1, kBytesPerSample / (size * batchSize));
+
+            // ciphertexts of the messages, laid out like the outputs, as input for the decrypt rows
+            auto encryptItems = set.items(set.inputs, size, size);
+            encrypt_batch(cipher, encryptItems, key);
+            ByteBuffer ciphertexts(set.outputs.begin(), set.outputs.end());
+            for (size_t i = 0; i < batchSize; ++i) {
+                const std::vector<unsigned char> iv(encryptItems[i].iv, encryptItems[i].iv + 16);
+                if (ByteSpan(encryptItems[i].out, encryptItems[i].outLength) != encrypt(cipher, encryptItems[i].input, key, iv)) {
+                    throw std::runtime_error("encrypt_batch mismatch for " + cipherName);
+                }
+            }
+            auto decryptItems = set.items(ciphertexts, outputSize, set.outputSize);
+            decrypt_batch(cipher, decryptItems, key);
+            for (size_t i = 0; i < batchSize; ++i) {
+                if (ByteSpan(decryptItems[i].out, decryptItems[i].outLength) != encryptItems[i].input) {
+                    throw std::runtime_error("decrypt_batch did not recover the plaintext for " + cipherName);
+                }
+            }
+
+            // the IVs as the per-message API takes them
+            std::vector<std::vector<unsigned char>> ivs;
+            for (size_t i = 0; i < batchSize; ++i) {
+                ivs.emplace_back(set.ivs.begin() + i * 16, set.ivs.begin() + (i + 1) * 16);
+            }
+
+            for (bool encryptOp : {true, false}) {
+                const std::string op = encryptOp ? "encrypt" : "decrypt";
+                auto& items = encryptOp ? encryptItems : decryptItems;
+                Rate single = measure(opts.timedIters, reps, batchSize, size, [&] {
+                    for (size_t i = 0; i < batchSize; ++i) {
+                        ByteBuffer out = encryptOp ? encrypt(cipher, items[i].input, key, ivs[i])
+                                                   : decrypt(cipher, items[i].input, key, ivs[i]);
+                    }
+                });
+                Rate batch = measure(opts.timedIters, reps, batchSize, size, [&] {
+                    if (encryptOp) {
+                        encrypt_batch(cipher, items, key);
+                    } else {
+                        decrypt_batch(cipher, items, key);
+                    }
+                });
+
+                std::cout << std::left << std::setw(8) << size << std::setw(10) << op << std::right
+                          << std::fixed << std::setprecision(1) << std::setw(20) << single.nsPerMessage
+                          << "      " << std::setw(14) << batch.nsPerMessage << "      "
+                          << std::setprecision(0) << std::setw(12) << batch.opsPerSec << "    "
+                          << std::setprecision(2) << single.nsPerMessage / batch.nsPerMessage << "x" << std::endl;
+                for (const auto& [variant, rate] : {std::make_pair("per-message", single),
+                                                    std::make_pair("batch", batch)}) {
+                    csv << cipherName << "," << op << "," << variant << "," << size << "," << batchSize << ","
+                        << opts.timedIters << "," << std::fixed << std::setprecision(0) << rate.opsPerSec << ","
+                        << std::setprecision(1) << rate.nsPerMessage << "," << std::setprecision(2)
+                        << rate.mbPerSec << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved batch results to: results/batch_results.csv" << std::endl;
+}
@@ -0,0 +1,332 @@
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+bool pathExists(const std::string& p) {
+    struct stat sb{};
+    return ::stat(p.c_str(), &sb) == 0;
+}
+
+void ensureDir(const std::string& dir) {
+    if (!pathExists(dir)) {
+        if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Failed to create directory: " + dir);
+        }
+    }
+}
+
+std::ofstream openResultsFile(const std::string& name) {
+    const std::string resultsDir = "results";
+    ensureDir(resultsDir);
+    std::string path = resultsDir + "/" + name;
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open results file for writing: " + path);
+    }
+    return out;
+}
+
+std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+std::pair<double, double> meanAndStddev(const std::vector<double>& samples) {
+    if (samples.empty()) {
+        return {0.0, 0.0};
+    }
+    double sum = 0.0; for (double v : samples) sum += v;
+    double mean = sum / samples.size();
+    double var = 0.0; for (double v : samples) var += (v - mean) * (v - mean); var /= samples.size();
+    return {mean, std::sqrt(var)};
+}
+
+std::pair<double, double> sampleThroughput(int iters, size_t reps, size_t bytes, const std::function<double()>& op) {
+    op();
+    std::vector<double> throughputs;
+    for (int i = 0; i < iters; ++i) {
+        double ms = 0.0;
+        for (size_t r = 0; r < reps; ++r) {
+            ms += op();
+        }
+        throughputs.push_back((static_cast<double>(reps) * bytes / 1.0e6) / (ms / 1000.0));
+    }
+    return meanAndStddev(throughputs);
+}
+
+std::pair<double, double> sampleWallThroughput(int iters, size_t reps, size_t bytes, const std::function<void()>& op) {
+    using clock = std::chrono::steady_clock;
+    op();
+    std::vector<double> throughputs;
+    for (int i = 0; i < iters; ++i) {
+        auto t0 = clock::now();
+        for (size_t r = 0; r < reps; ++r) {
+            op();
+        }
+        std::chrono::duration<double> dt = clock::now() - t0;
+        throughputs.push_back((static_cast<double>(reps) * bytes / 1.0e6) / dt.count());
+    }
+    return meanAndStddev(throughputs);
+}
+
+std::pair<double, double> nsPerMessage(int iters, size_t messages, const std::function<void(size_t)>& op,
+                                       const std::function<void()>& afterWarmup) {
+    using clock = std::chrono::steady_clock;
+    for (size_t m = 0; m < messages; ++m) {
+        op(m);
+    }
+    if (afterWarmup) {
+        afterWarmup();
+    }
+    std::vector<double> samples;
+    for (int i = 0; i < iters; ++i) {
+        auto t0 = clock::now();
+        for (size_t m = 0; m < messages; ++m) {
+            op(m);
+        }
+        std::chrono::duration<double, std::nano> dt = clock::now() - t0;
+        samples.push_back(dt.count() / static_cast<double>(messages));
+    }
+    return meanAndStddev(samples);
+}
+
+std::vector<std::vector<unsigned char>> randomIvs() {
+    const auto pool = generateRandomBytes(kIvPoolSize * 16);
+    std::vector<std::vector<unsigned char>> ivs;
+    for (size_t i = 0; i < kIvPoolSize; ++i) {
+        ivs.emplace_back(pool.begin() + i * 16, pool.begin() + (i + 1) * 16);
+    }
+    return ivs;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const double rank = std::ceil(p / 100.0 * static_cast<double>(sorted.size()));
+    const size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+std::string formatBytes(size_t bytes) {
+    static const char* units[] = {"B", "K", "M", "G", "T"};
+    double value = static_cast<double>(bytes);
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4) {
+        value /= 1024.0;
+        ++unit;
+    }
+    std::ostringstream out;
+    out << std::setprecision(value < 10.0 && unit > 0 ? 2 : 4) << value << units[unit];
+    return out.str();
+}
+
+namespace {
+// value of a "Key:   1234 kB" line in /proc/self/status, or -1
+long procStatusKb(const std::string& key) {
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, key.size() + 1, key + ":") == 0) {
+            return std::stol(line.substr(key.size() + 1));
+        }
+    }
+    return -1;
+}
+}
+
+const char* const kResourceCsvHeader = ",PeakRSS(KB),MinorFaults,MajorFaults,VoluntaryCtxSwitches,InvoluntaryCtxSwitches";
+
+ResourceMeter::ResourceMeter() {
+    // "5" resets VmHWM to the current RSS (Linux 4.0+); harmless if unsupported
+    std::ofstream("/proc/self/clear_refs") << "5";
+    struct rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    minorFaults_ = usage.ru_minflt;
+    majorFaults_ = usage.ru_majflt;
+    voluntarySwitches_ = usage.ru_nvcsw;
+    involuntarySwitches_ = usage.ru_nivcsw;
+}
+
+CellResources ResourceMeter::finish() const {
+    struct rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    CellResources r;
+    r.peakRssKb = procStatusKb("VmHWM");
+    if (r.peakRssKb < 0) {
+        r.peakRssKb = usage.ru_maxrss; // lifetime peak, in KB on Linux
+    }
+    r.minorFaults = usage.ru_minflt - minorFaults_;
+    r.majorFaults = usage.ru_majflt - majorFaults_;
+    r.voluntarySwitches = usage.ru_nvcsw - voluntarySwitches_;
+    r.involuntarySwitches = usage.ru_nivcsw - involuntarySwitches_;
+    return r;
+}
+
+void writeResourceCsv(std::ostream& out, const CellResources& r) {
+    out << "," << r.peakRssKb << "," << r.minorFaults << "," << r.majorFaults << ","
+        << r.voluntarySwitches << "," << r.involuntarySwitches;
+}
+
+std::string formatResources(const CellResources& r) {
+    std::ostringstream out;
+    out << "peak RSS " << std::fixed << std::setprecision(1) << r.peakRssKb / 1024.0 << " MB, faults "
+        << r.minorFaults << " minor / " << r.majorFaults << " major, ctx switches "
+        << r.voluntarySwitches << " voluntary / " << r.involuntarySwitches << " involuntary";
+    return out.str();
+}
+
+int availableCpus() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return CPU_COUNT(&set);
+    }
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw ? static_cast<int>(hw) : 1;
+}
+
+void pinCurrentThread(int cpuIndex, const std::vector<int>& cpus) {
+    if (!cpus.empty()) {
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpus[cpuIndex % cpus.size()], &one);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(one), &one);
+        return;
+    }
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return;
+    }
+    // map the index onto the n-th allowed CPU
+    int target = cpuIndex % CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(one), &one);
+            return;
+        }
+    }
+}
+
+std::vector<int> cpusForNode(int node) {
+    std::vector<int> cpus;
+    if (node < 0) {
+        return cpus;
+    }
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    ::sched_getaffinity(0, sizeof(allowed), &allowed);
+    for (const auto& numa : detectNumaNodes()) {
+        if (numa.id != node) {
+            continue;
+        }
+        for (int cpu : numa.cpus) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty()) {
+            throw std::runtime_error("No usable CPUs on NUMA node " + std::to_string(node));
+        }
+        return cpus;
+    }
+    throw std::runtime_error("No such NUMA node: " + std::to_string(node));
+}
+
+std::vector<int> defaultThreadCounts(const std::vector<int>& requested) {
+    if (!requested.empty()) {
+        return requested;
+    }
+    std::vector<int> counts;
+    const int cpus = availableCpus();
+    for (int t = 1; t < cpus; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(cpus);
+    return counts;
+}
+
+double runParallel(int threads, const std::function<void(int)>& work, const std::vector<int>& cpus) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<bool> cancelled{false};
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+
+    try {
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                pinCurrentThread(t, cpus);
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                if (cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                try {
+                    work(t);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+    } catch (...) {
+        // a thread could not be created (std::system_error): release the started ones without
+        // running `work` and join them, since destroying a joinable std::thread terminates
+        cancelled.store(true, std::memory_order_relaxed);
+        go.store(true, std::memory_order_release);
+        for (auto& th : pool) {
+            th.join();
+        }
+        throw;
+    }
+
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : pool) {
+        th.join();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    for (auto& err : errors) {
+        if (err) {
+            std::rethrow_exception(err);
+        }
+    }
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
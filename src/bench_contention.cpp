@@ -0,0 +1,171 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "cipher_cache.hpp"
+#include "crypto_utils.hpp"
+
+#include <openssl/evp.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+// message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {16, 64, 256};
+
+// short operations per thread per timed sample
+const size_t kOpsPerThread = 20000;
+
+// how each operation gets its cipher and context
+enum class Mitigation {
+    NONE,           // new context, legacy cipher (implicit fetch in the shared library context)
+    THREAD_LIBCTX,  // new context, cipher fetched per operation from the thread's own OSSL_LIB_CTX
+    PREFETCHED,     // new context, cipher from the process-wide cache
+    POOLED,         // the thread's reused context, bound to the cached cipher once, re-keyed per operation
+};
+
+std::string mitigationToString(Mitigation m) {
+    switch (m) {
+        case Mitigation::NONE:
+            return "implicit";
+        case Mitigation::THREAD_LIBCTX:
+            return "per-thread libctx";
+        case Mitigation::PREFETCHED:
+            return "pre-fetched";
+        case Mitigation::POOLED:
+            return "pooled ctx";
+        default:
+            return "unknown";
+    }
+}
+
+// what one worker thread owns; set up before the threads are released so it is not timed
+struct ThreadState {
+    ThreadState() : ctx(EVP_CIPHER_CTX_new()), out(256 + 32) {
+        if (!ctx) {
+            throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+        }
+    }
+    ~ThreadState() {
+        EVP_CIPHER_CTX_free(ctx);
+        OSSL_LIB_CTX_free(libctx);
+    }
+    ThreadState(const ThreadState&) = delete;
+    ThreadState& operator=(const ThreadState&) = delete;
+
+    OSSL_LIB_CTX* libctx = nullptr;
+    EVP_CIPHER_CTX* ctx;
+    bool ctxBound = false; // ctx already has the cipher, so re-init passes only key and IV
+    ByteBuffer out;
+};
+
+// context new -> init -> update -> final -> free, as a service handling one short message would do
+void shortOperation(Mitigation m, ThreadState& state, CipherType cipher, const std::string& name,
+                    ByteSpan message, const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv) {
+    EVP_CIPHER* fetched = nullptr;
+    const EVP_CIPHER* evpCipherPtr = nullptr;
+    switch (m) {
+        case Mitigation::NONE:
+            evpCipherPtr = legacyCipher(cipher);
+            break;
+        case Mitigation::THREAD_LIBCTX:
+            fetched = EVP_CIPHER_fetch(state.libctx, name.c_str(), nullptr);
+            if (!fetched) {
+                throw std::runtime_error("EVP_CIPHER_fetch failed in a per-thread library context");
+            }
+            evpCipherPtr = fetched;
+            break;
+        case Mitigation::PREFETCHED:
+            evpCipherPtr = evpCipher(cipher);
+            break;
+        case Mitigation::POOLED:
+            evpCipherPtr = state.ctxBound ? nullptr : evpCipher(cipher);
+            state.ctxBound = true;
+            break;
+    }
+    EVP_CIPHER_CTX* ctx = m == Mitigation::POOLED ? state.ctx : EVP_CIPHER_CTX_new();
+    int len = 0;
+    int finalLen = 0;
+    const bool ok = ctx
+        && EVP_EncryptInit_ex(ctx, evpCipherPtr, nullptr, key.data(), iv.data()) == 1
+        && EVP_EncryptUpdate(ctx, state.out.data(), &len, message.data(), static_cast<int>(message.size())) == 1
+        && EVP_EncryptFinal_ex(ctx, state.out.data() + len, &finalLen) == 1;
+    if (m != Mitigation::POOLED) {
+        EVP_CIPHER_CTX_free(ctx);
+    }
+    EVP_CIPHER_free(fetched);
+    if (!ok) {
+        throw std::runtime_error("short " + cipherTypeToString(cipher) + " encryption failed");
+    }
+}
+}
+
+void runInitContention(const BenchOptions& opts) {
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    for (size_t size : sizes) {
+        if (size > 256) {
+            throw std::invalid_argument("--mode=contention measures short operations; --sizes must be at most 256 bytes");
+        }
+    }
+    const std::vector<int> threadCounts = defaultThreadCounts(opts.threadCounts);
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+
+    auto csv = openResultsFile("contention_results.csv");
+    csv << "Cipher,Variant,MessageSize(Bytes),Threads,Runs,Ops/s,StdDev(Ops/s),PerThreadOps/s,ScalingEfficiency\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const std::string name = evpCipherName(cipher);
+        std::cout << "\n--- Init contention: " << name << ", new ctx -> init -> update -> final -> free ---" << std::endl;
+        std::cout << std::left << std::setw(20) << "Variant" << std::setw(8) << "Size" << std::setw(10) << "Threads"
+                  << std::right << std::setw(14) << "ops/s" << std::setw(16) << "per thread" << std::setw(14)
+                  << "scaling" << std::endl;
+
+        for (Mitigation m : {Mitigation::NONE, Mitigation::THREAD_LIBCTX, Mitigation::PREFETCHED, Mitigation::POOLED}) {
+            for (size_t size : sizes) {
+                const auto message = generateRandomBytes(size);
+                double singleThreadRate = 0.0;
+                for (int threads : threadCounts) {
+                    std::vector<std::unique_ptr<ThreadState>> states;
+                    for (int t = 0; t < threads; ++t) {
+                        states.push_back(std::make_unique<ThreadState>());
+                        if (m == Mitigation::THREAD_LIBCTX) {
+                            states.back()->libctx = OSSL_LIB_CTX_new();
+                            if (!states.back()->libctx) {
+                                throw std::runtime_error("OSSL_LIB_CTX_new failed");
+                            }
+                        }
+                    }
+                    auto sample = [&] {
+                        return runParallel(threads, [&](int t) {
+                            for (size_t i = 0; i < kOpsPerThread; ++i) {
+                                shortOperation(m, *states[t], cipher, name, message, key, iv);
+                            }
+                        });
+                    };
+                    sample(); // warm-up, also loads the providers into the per-thread library contexts
+                    std::vector<double> rates;
+                    for (int i = 0; i < opts.timedIters; ++i) {
+                        rates.push_back(static_cast<double>(kOpsPerThread) * threads / (sample() / 1000.0));
+                    }
+                    auto [rate, stddev] = meanAndStddev(rates);
+                    if (threads == threadCounts.front()) {
+                        singleThreadRate = rate / threads;
+                    }
+                    // 1.0 means perfect scaling from the first (usually single-thread) row
+                    const double efficiency = rate / (singleThreadRate * threads);
+                    std::cout << std::left << std::setw(20) << mitigationToString(m) << std::setw(8) << size
+                              << std::setw(10) << threads << std::right << std::fixed << std::setprecision(0)
+                              << std::setw(14) << rate << std::setw(16) << rate / threads << std::setprecision(2)
+                              << std::setw(14) << efficiency << std::endl;
+                    csv << cipherName << "," << mitigationToString(m) << "," << size << "," << threads << ","
+                        << opts.timedIters << "," << std::fixed << std::setprecision(0) << rate << "," << stddev
+                        << "," << rate / threads << "," << std::setprecision(3) << efficiency << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved contention results to: results/contention_results.csv" << std::endl;
+}
@@ -0,0 +1,114 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "cipher_cache.hpp"
+#include "crypto_utils.hpp"
+
+#include <openssl/evp.h>
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// cipher inits per thread per timed sample
+const size_t kInitsPerSample = 20000;
+
+// one way of obtaining the EVP_CIPHER that is passed to EVP_CipherInit_ex
+struct Variant {
+    std::string name;
+    std::function<void(EVP_CIPHER_CTX*, CipherType, const unsigned char*, const unsigned char*)> init;
+};
+
+void checkedInit(EVP_CIPHER_CTX* ctx, const EVP_CIPHER* cipher, const unsigned char* key, const unsigned char* iv) {
+    if (EVP_CipherInit_ex(ctx, cipher, nullptr, key, iv, 1) != 1) {
+        throw std::runtime_error("EVP_CipherInit_ex failed");
+    }
+}
+
+std::vector<Variant> variants() {
+    return {
+        {"implicit (EVP_xxx_cbc())",
+         [](EVP_CIPHER_CTX* ctx, CipherType c, const unsigned char* key, const unsigned char* iv) {
+             checkedInit(ctx, legacyCipher(c), key, iv);
+         }},
+        {"implicit (by name)",
+         [](EVP_CIPHER_CTX* ctx, CipherType c, const unsigned char* key, const unsigned char* iv) {
+             checkedInit(ctx, EVP_get_cipherbyname(evpCipherName(c).c_str()), key, iv);
+         }},
+        {"fetch per init",
+         [](EVP_CIPHER_CTX* ctx, CipherType c, const unsigned char* key, const unsigned char* iv) {
+             EVP_CIPHER* fetched = EVP_CIPHER_fetch(nullptr, evpCipherName(c).c_str(), nullptr);
+             if (!fetched) {
+                 throw std::runtime_error("EVP_CIPHER_fetch failed");
+             }
+             checkedInit(ctx, fetched, key, iv);
+             EVP_CIPHER_free(fetched);
+         }},
+        {"pre-fetched",
+         [](EVP_CIPHER_CTX* ctx, CipherType c, const unsigned char* key, const unsigned char* iv) {
+             checkedInit(ctx, evpCipher(c), key, iv);
+         }},
+    };
+}
+
+// each of `threads` threads runs kInitsPerSample inits on its own context; returns the wall time in ms
+double timeInits(int threads, const Variant& variant, CipherType cipher, const std::vector<unsigned char>& key,
+                 const std::vector<unsigned char>& iv) {
+    return runParallel(threads, [&](int) {
+        EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+        if (!ctx) {
+            throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+        }
+        try {
+            for (size_t i = 0; i < kInitsPerSample; ++i) {
+                variant.init(ctx, cipher, key.data(), iv.data());
+            }
+        } catch (...) {
+            EVP_CIPHER_CTX_free(ctx);
+            throw;
+        }
+        EVP_CIPHER_CTX_free(ctx);
+    });
+}
+}
+
+void runFetchBenchmark(const BenchOptions& opts) {
+    const std::vector<int> threadCounts = defaultThreadCounts(opts.threadCounts);
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+    const std::vector<Variant> all = variants();
+
+    auto csv = openResultsFile("fetch_results.csv");
+    csv << "Cipher,Variant,Threads,Runs,ns/Init,Inits/s,StdDev(Inits/s)\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        std::cout << "\n--- " << evpCipherName(cipher) << ": EVP_CipherInit_ex cost per way of obtaining the cipher ---"
+                  << std::endl;
+        std::cout << std::left << std::setw(28) << "Variant" << std::setw(10) << "Threads" << std::right
+                  << std::setw(14) << "ns/init" << std::setw(16) << "inits/s" << std::endl;
+
+        for (const auto& variant : all) {
+            for (int threads : threadCounts) {
+                timeInits(threads, variant, cipher, key, iv); // warm-up
+                std::vector<double> rates;
+                for (int i = 0; i < opts.timedIters; ++i) {
+                    const double ms = timeInits(threads, variant, cipher, key, iv);
+                    rates.push_back(static_cast<double>(kInitsPerSample) * threads / (ms / 1000.0));
+                }
+                auto [rate, stddev] = meanAndStddev(rates);
+                // wall time of one init as seen by one thread
+                const double nsPerInit = 1.0e9 * threads / rate;
+                std::cout << std::left << std::setw(28) << variant.name << std::setw(10) << threads << std::right
+                          << std::fixed << std::setprecision(1) << std::setw(14) << nsPerInit
+                          << std::setprecision(0) << std::setw(16) << rate << std::endl;
+                csv << cipherName << "," << variant.name << "," << threads << "," << opts.timedIters << ","
+                    << std::fixed << std::setprecision(1) << nsPerInit << "," << std::setprecision(0) << rate
+                    << "," << stddev << "\n";
+            }
+        }
+    }
+    std::cout << "\nSaved fetch results to: results/fetch_results.csv" << std::endl;
+}
@@ -0,0 +1,192 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+// a packet-size distribution: sizes in bytes with relative weights (packets, not bytes)
+struct PacketMix {
+    std::string name;
+    std::vector<std::pair<size_t, int>> weights;
+};
+
+// built-in mixes, selectable with --mixes
+const std::vector<PacketMix> kBuiltinMixes = {
+    {"imix", {{64, 7}, {576, 4}, {1500, 1}}},         // classic simple IMIX (7:4:1)
+    {"trimodal", {{64, 1}, {576, 1}, {1500, 1}}},     // 64/576/1500 B in equal numbers
+    {"jumbo", {{64, 7}, {1500, 4}, {9000, 1}}},       // IMIX with jumbo frames for the large packets
+};
+
+// plaintext bytes per timed pass over a packet stream
+const size_t kBytesPerSample = 4 * 1024 * 1024;
+
+// fixed seed, so that every cipher and run sees the same packet order
+const uint64_t kShuffleSeed = 0x1e1f;
+
+// the mixes to run: the --mixes built-ins (all by default) plus --mix as "custom"
+std::vector<PacketMix> selectedMixes(const BenchOptions& opts) {
+    std::vector<PacketMix> mixes;
+    if (opts.packetMixes.empty()) {
+        mixes = kBuiltinMixes;
+    }
+    for (const auto& name : opts.packetMixes) {
+        auto it = std::find_if(kBuiltinMixes.begin(), kBuiltinMixes.end(),
+                               [&](const PacketMix& mix) { return mix.name == name; });
+        if (it == kBuiltinMixes.end()) {
+            throw std::invalid_argument("Unknown packet mix: '" + name + "' (expected imix, trimodal or jumbo)");
+        }
+        mixes.push_back(*it);
+    }
+    if (!opts.customMix.empty()) {
+        mixes.push_back({"custom", opts.customMix});
+    }
+    return mixes;
+}
+
+// Whole repeats of the mix's weights (at least kBytesPerSample bytes), shuffled so that sizes
+// interleave as on a link instead of arriving in runs; the stream holds every size in exact
+// proportion. Packets are stored as indexes into mix.weights.
+std::vector<size_t> packetStream(const PacketMix& mix) {
+    size_t cycleBytes = 0;
+    for (const auto& [size, weight] : mix.weights) {
+        cycleBytes += size * static_cast<size_t>(weight);
+    }
+    const size_t cycles = std::max<size_t>(1, (kBytesPerSample + cycleBytes - 1) / cycleBytes);
+    std::vector<size_t> stream;
+    for (size_t c = 0; c < cycles; ++c) {
+        for (size_t s = 0; s < mix.weights.size(); ++s) {
+            stream.insert(stream.end(), static_cast<size_t>(mix.weights[s].second), s);
+        }
+    }
+    std::mt19937_64 rng(kShuffleSeed);
+    std::shuffle(stream.begin(), stream.end(), rng);
+    return stream;
+}
+
+// mean seconds per pass of process(packet, i) over `stream`, and its stddev
+std::pair<double, double> secondsPerPass(int iters, const std::vector<size_t>& stream,
+                                         const std::function<void(size_t, size_t)>& process) {
+    const auto [ns, stddev] = nsPerMessage(iters, stream.size(), [&](size_t i) { process(stream[i], i); });
+    return {ns * stream.size() / 1.0e9, stddev * stream.size() / 1.0e9};
+}
+}
+
+void runPacketMix(const BenchOptions& opts) {
+    const std::vector<PacketMix> mixes = selectedMixes(opts);
+    size_t maxSize = 0;
+    for (const auto& mix : mixes) {
+        for (const auto& entry : mix.weights) {
+            maxSize = std::max(maxSize, entry.first);
+        }
+    }
+    const auto key = generateRandomBytes(16);
+    const auto ivs = randomIvs();
+    const auto payload = generateRandomBytes(maxSize);
+
+    auto csv = openResultsFile("imix_results.csv");
+    csv << "Cipher,Mix,Operation,PacketSize(Bytes),Weight,PacketShare(%),ByteShare(%),Runs,Packets/s,"
+           "Throughput(MB/s),StdDev(MB/s),TimeShare(%)\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        // one tunnel: a keyed session per direction, with a fresh IV per packet (see CipherSession)
+        CipherSession encryptSession(cipher, true, key);
+        CipherSession decryptSession(cipher, false, key);
+        ByteBuffer out(maxSize + cipherBlockSize(cipher));
+
+        for (const auto& mix : mixes) {
+            // ciphertext of every packet size under every IV, as input for the decrypt rows
+            std::vector<std::vector<ByteBuffer>> ciphertexts(mix.weights.size());
+            for (size_t s = 0; s < mix.weights.size(); ++s) {
+                const auto& entry = mix.weights[s];
+                auto& perIv = ciphertexts[s];
+                for (const auto& iv : ivs) {
+                    perIv.push_back(encrypt(cipher, ByteSpan(payload.data(), entry.first), key, iv));
+                }
+            }
+            const std::vector<size_t> stream = packetStream(mix);
+            size_t streamBytes = 0;
+            for (size_t packet : stream) {
+                streamBytes += mix.weights[packet].first;
+            }
+            size_t totalWeight = 0;
+            size_t cycleBytes = 0;
+            for (const auto& [size, weight] : mix.weights) {
+                totalWeight += static_cast<size_t>(weight);
+                cycleBytes += size * static_cast<size_t>(weight);
+            }
+
+            std::cout << "\n--- " << cipherName << ", mix " << mix.name << " (";
+            for (size_t i = 0; i < mix.weights.size(); ++i) {
+                std::cout << (i ? ", " : "") << mix.weights[i].first << " B x" << mix.weights[i].second;
+            }
+            std::cout << "; mean packet " << std::fixed << std::setprecision(1)
+                      << static_cast<double>(cycleBytes) / totalWeight << " B) ---" << std::endl;
+
+            for (bool encryptOp : {true, false}) {
+                const std::string op = encryptOp ? "encrypt" : "decrypt";
+                auto process = [&](size_t packet, size_t i) {
+                    const unsigned char* iv = ivs[i % kIvPoolSize].data();
+                    if (encryptOp) {
+                        encryptSession.process(ByteSpan(payload.data(), mix.weights[packet].first), iv, out.data());
+                    } else {
+                        decryptSession.process(ciphertexts[packet][i % kIvPoolSize], iv, out.data());
+                    }
+                };
+
+                // the mixed stream, then every size on its own for the breakdown
+                const auto [mixSeconds, mixStddev] = secondsPerPass(opts.timedIters, stream, process);
+                const double mixMbps = streamBytes / 1.0e6 / mixSeconds;
+                std::vector<std::pair<double, double>> alone;
+                double predictedNs = 0.0;
+                for (size_t s = 0; s < mix.weights.size(); ++s) {
+                    const auto& [size, weight] = mix.weights[s];
+                    const std::vector<size_t> single(std::max<size_t>(1024, kBytesPerSample / size), s);
+                    const auto [seconds, stddev] = secondsPerPass(opts.timedIters, single, process);
+                    const double nsPerPacket = seconds * 1.0e9 / single.size();
+                    alone.emplace_back(nsPerPacket, stddev * 1.0e9 / single.size());
+                    predictedNs += nsPerPacket * weight;
+                }
+                predictedNs /= totalWeight;
+
+                std::cout << op << ": " << std::setprecision(2) << mixMbps << " MB/s (stddev "
+                          << mixMbps * mixStddev / mixSeconds << "), " << std::setprecision(0)
+                          << stream.size() / mixSeconds << " packets/s; sizes measured alone predict "
+                          << 1.0e9 / predictedNs << " packets/s" << std::endl;
+                std::cout << "  " << std::left << std::setw(10) << "Size" << std::right << std::setw(10) << "packets"
+                          << std::setw(10) << "bytes" << std::setw(16) << "alone (pkt/s)" << std::setw(14)
+                          << "alone (MB/s)" << std::setw(12) << "time share" << std::endl;
+                csv << cipherName << "," << mix.name << "," << op << ",mix," << totalWeight << ",100.0,100.0,"
+                    << opts.timedIters << "," << std::fixed << std::setprecision(0) << stream.size() / mixSeconds
+                    << "," << std::setprecision(2) << mixMbps << "," << mixMbps * mixStddev / mixSeconds
+                    << ",100.0\n";
+
+                for (size_t s = 0; s < mix.weights.size(); ++s) {
+                    const auto& [size, weight] = mix.weights[s];
+                    const double ns = alone[s].first;
+                    const double packetShare = 100.0 * weight / totalWeight;
+                    const double byteShare = 100.0 * static_cast<double>(size) * weight / cycleBytes;
+                    // share of the predicted mix time spent on packets of this size
+                    const double timeShare = 100.0 * ns * weight / (predictedNs * totalWeight);
+                    const double mbps = size / 1.0e6 * (1.0e9 / ns);
+                    std::cout << "  " << std::left << std::setw(10) << std::to_string(size) + " B" << std::right
+                              << std::setprecision(1) << std::setw(9) << packetShare << "%" << std::setw(9)
+                              << byteShare << "%" << std::setprecision(0) << std::setw(16) << 1.0e9 / ns
+                              << std::setprecision(2) << std::setw(14) << mbps << std::setprecision(1)
+                              << std::setw(11) << timeShare << "%" << std::endl;
+                    csv << cipherName << "," << mix.name << "," << op << "," << size << "," << weight << ","
+                        << std::setprecision(1) << packetShare << "," << byteShare << "," << opts.timedIters << ","
+                        << std::setprecision(0) << 1.0e9 / ns << "," << std::setprecision(2) << mbps << ","
+                        << mbps * alone[s].second / ns << "," << std::setprecision(1) << timeShare << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved packet mix results to: results/imix_results.csv" << std::endl;
+}
@@ -0,0 +1,141 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+// message sizes compared when --sizes is not given: L1/L2 resident up to well past the L2
+const std::vector<size_t> kDefaultSizes = {
+    size_t{4} << 10,
+    size_t{64} << 10,
+    size_t{1} << 20,
+    size_t{16} << 20,
+    size_t{64} << 20,
+};
+
+// plaintext bytes processed per timed sample, so that small messages are repeated many times
+const size_t kBytesPerSample = 16 * 1024 * 1024;
+
+// one benchmark cell: throughput of one variant of one operation
+struct CellResult {
+    double mean = 0.0;   // MB/s of plaintext
+    double stddev = 0.0;
+    size_t footprint = 0; // bytes of buffer memory the variant touches
+    CellResources resources;
+};
+
+void checkRecovered(const unsigned char* recovered, ByteSpan message, const std::string& what) {
+    if (ByteSpan(recovered, message.size()) != message) {
+        throw std::runtime_error("In-place benchmark: " + what + " did not recover the plaintext");
+    }
+}
+
+// separate input and output buffers (encrypt_into/decrypt_into_with_timing)
+CellResult runOutOfPlace(CipherType cipher, bool encryptOp, ByteSpan message, size_t reps,
+                         const BenchOptions& opts, const std::vector<unsigned char>& key,
+                         const std::vector<unsigned char>& iv) {
+    ResourceMeter meter; // covers buffer setup too: that is the cell's memory cost
+    const size_t size = message.size();
+    const size_t padded = paddedLength(cipher, size);
+    AlignedBuffer in(encryptOp ? size : padded, opts.layout.pageSize, opts.layout.numaNode);
+    AlignedBuffer out(padded, opts.layout.pageSize, opts.layout.numaNode);
+
+    CellResult result;
+    result.footprint = in.size() + out.size();
+    if (encryptOp) {
+        std::memcpy(in.data(), message.data(), size);
+        std::tie(result.mean, result.stddev) = sampleThroughput(opts.timedIters, reps, size, [&] {
+            return encrypt_into_with_timing(cipher, in.data(), size, out.data(), key, iv).second;
+        });
+    } else {
+        encrypt_into_with_timing(cipher, message.data(), size, in.data(), key, iv);
+        std::tie(result.mean, result.stddev) = sampleThroughput(opts.timedIters, reps, size, [&] {
+            return decrypt_into_with_timing(cipher, in.data(), padded, out.data(), key, iv).second;
+        });
+        checkRecovered(out.data(), message, "out-of-place decryption");
+    }
+    result.resources = meter.finish();
+    return result;
+}
+
+// one buffer holding the message plus room for the padding block (encrypt/decrypt_in_place_with_timing)
+CellResult runInPlace(CipherType cipher, bool encryptOp, ByteSpan message, size_t reps,
+                      const BenchOptions& opts, const std::vector<unsigned char>& key,
+                      const std::vector<unsigned char>& iv) {
+    ResourceMeter meter;
+    const size_t size = message.size();
+    const size_t padded = paddedLength(cipher, size);
+    AlignedBuffer buf(padded, opts.layout.pageSize, opts.layout.numaNode);
+    std::memcpy(buf.data(), message.data(), size);
+
+    CellResult result;
+    result.footprint = buf.size();
+    if (encryptOp) {
+        // every call re-encrypts the first `size` bytes, which only changes their contents
+        std::tie(result.mean, result.stddev) = sampleThroughput(opts.timedIters, reps, size, [&] {
+            return encrypt_in_place_with_timing(cipher, buf.data(), size, padded, key, iv).second;
+        });
+    } else {
+        encrypt_in_place_with_timing(cipher, buf.data(), size, padded, key, iv);
+        std::tie(result.mean, result.stddev) = sampleThroughput(opts.timedIters, reps, size, [&] {
+            double ms = decrypt_in_place_with_timing(cipher, buf.data(), padded, key, iv).second;
+            // same key and IV, so re-encrypting restores the ciphertext without a second buffer (untimed)
+            encrypt_in_place_with_timing(cipher, buf.data(), size, padded, key, iv);
+            return ms;
+        });
+        decrypt_in_place_with_timing(cipher, buf.data(), padded, key, iv);
+        checkRecovered(buf.data(), message, "in-place decryption");
+    }
+    result.resources = meter.finish();
+    return result;
+}
+}
+
+void runInPlaceBenchmark(const BenchOptions& opts) {
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+
+    auto csv = openResultsFile("inplace_results.csv");
+    csv << "Cipher,Operation,Variant,Size(Bytes),Footprint(Bytes),Runs,Throughput(MB/s),StdDev(MB/s)"
+        << kResourceCsvHeader << "\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        std::cout << "\n--- In-place vs out-of-place: " << cipherName << " ---" << std::endl;
+        std::cout << std::left << std::setw(10) << "Size" << std::setw(10) << "Op"
+                  << std::setw(22) << "out-of-place (MB/s)" << std::setw(20) << "in-place (MB/s)"
+                  << "ratio" << std::right << std::endl;
+
+        for (size_t size : sizes) {
+            const auto message = generateRandomBytes(size);
+            const size_t reps = std::max<size_t>(1, kBytesPerSample / size);
+            for (bool encryptOp : {true, false}) {
+                const std::string op = encryptOp ? "encrypt" : "decrypt";
+                CellResult separate = runOutOfPlace(cipher, encryptOp, message, reps, opts, key, iv);
+                CellResult aliased = runInPlace(cipher, encryptOp, message, reps, opts, key, iv);
+
+                std::cout << std::left << std::setw(10) << formatBytes(size) << std::setw(10) << op
+                          << std::right << std::fixed << std::setprecision(2)
+                          << std::setw(19) << separate.mean << "   " << std::setw(17) << aliased.mean
+                          << "   " << std::setprecision(3) << aliased.mean / separate.mean << std::endl;
+                for (const auto& [variant, cell] : {std::make_pair("out-of-place", &separate),
+                                                    std::make_pair("in-place", &aliased)}) {
+                    csv << cipherName << "," << op << "," << variant << "," << size << "," << cell->footprint
+                        << "," << opts.timedIters << "," << std::fixed << std::setprecision(2)
+                        << cell->mean << "," << cell->stddev;
+                    writeResourceCsv(csv, cell->resources);
+                    csv << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved in-place results to: results/inplace_results.csv" << std::endl;
+}
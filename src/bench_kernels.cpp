@@ -0,0 +1,138 @@
+#include "bench_modes.hpp"
+#include "aes_kernels.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {
+    size_t{1} << 10,
+    size_t{16} << 10,
+    size_t{256} << 10,
+    size_t{4} << 20,
+};
+
+// plaintext bytes processed per timed sample
+const size_t kBytesPerSample = 16 * 1024 * 1024;
+
+// an implementation under test, with the into_with_timing signature
+struct Implementation {
+    std::string name;
+    std::function<std::pair<size_t, double>(const unsigned char*, size_t, unsigned char*)> encrypt;
+    std::function<std::pair<size_t, double>(const unsigned char*, size_t, unsigned char*)> decrypt;
+};
+
+// the kernel must produce EVP's ciphertext and recover the plaintext, for whole and partial blocks
+void verifyAgainstEvp(const Implementation& evp, const Implementation& impl, const std::string& cipherName,
+                      ByteSpan message) {
+    for (size_t length : {message.size(), message.size() > 5 ? message.size() - 5 : message.size()}) {
+        ByteBuffer expected(length + 16);
+        ByteBuffer actual(length + 16);
+        ByteBuffer recovered(length + 16);
+        const size_t expectedLen = evp.encrypt(message.data(), length, expected.data()).first;
+        const size_t actualLen = impl.encrypt(message.data(), length, actual.data()).first;
+        if (ByteSpan(actual.data(), actualLen) != ByteSpan(expected.data(), expectedLen)) {
+            throw std::runtime_error(impl.name + " " + cipherName + " encryption differs from EVP at "
+                                     + std::to_string(length) + " bytes");
+        }
+        const size_t recoveredLen = impl.decrypt(actual.data(), actualLen, recovered.data()).first;
+        if (ByteSpan(recovered.data(), recoveredLen) != ByteSpan(message.data(), length)) {
+            throw std::runtime_error(impl.name + " " + cipherName + " decryption did not recover the plaintext at "
+                                     + std::to_string(length) + " bytes");
+        }
+    }
+}
+}
+
+void runKernelComparison(const BenchOptions& opts) {
+    if (std::find(opts.ciphers.begin(), opts.ciphers.end(), CipherType::AES) == opts.ciphers.end()) {
+        std::cout << "The in-tree kernels implement AES only; nothing to do for the selected ciphers" << std::endl;
+        return;
+    }
+    std::cout << "In-tree kernels:";
+    for (AesIsa isa : {AesIsa::AESNI, AesIsa::VAES}) {
+        std::cout << " " << aesIsaToString(isa) << (aesIsaAvailable(isa) ? " (available)" : " (unavailable)");
+    }
+    std::cout << std::endl;
+    if (!aesKernelsOptimised()) {
+        std::cout << "Warning: the in-tree kernels were built without optimisation and are not comparable with "
+                     "EVP (rebuild with -DCMAKE_BUILD_TYPE=Release)" << std::endl;
+    }
+
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const auto iv = generateRandomBytes(16);
+
+    auto csv = openResultsFile("kernel_results.csv");
+    csv << "Cipher,Operation,Implementation,Size(Bytes),Runs,Throughput(MB/s),StdDev(MB/s)\n";
+
+    for (size_t keyBytes : {size_t{16}, size_t{32}}) {
+        const auto key = generateRandomBytes(keyBytes);
+        for (AesMode mode : {AesMode::CBC, AesMode::CTR}) {
+            const std::string cipherName = aesEvpName(mode, keyBytes);
+            std::vector<Implementation> impls = {{
+                "EVP",
+                [&](const unsigned char* in, size_t n, unsigned char* out) {
+                    return evp_encrypt_into_with_timing(cipherName, in, n, out, key, iv);
+                },
+                [&](const unsigned char* in, size_t n, unsigned char* out) {
+                    return evp_decrypt_into_with_timing(cipherName, in, n, out, key, iv);
+                },
+            }};
+            for (AesIsa isa : {AesIsa::AESNI, AesIsa::VAES}) {
+                if (!aesIsaAvailable(isa)) {
+                    continue;
+                }
+                impls.push_back({
+                    aesIsaToString(isa),
+                    [&, isa, mode](const unsigned char* in, size_t n, unsigned char* out) {
+                        return aes_kernel_encrypt_into_with_timing(isa, mode, in, n, out, key, iv);
+                    },
+                    [&, isa, mode](const unsigned char* in, size_t n, unsigned char* out) {
+                        return aes_kernel_decrypt_into_with_timing(isa, mode, in, n, out, key, iv);
+                    },
+                });
+            }
+
+            std::cout << "\n--- " << cipherName << ": EVP vs in-tree kernels (MB/s) ---" << std::endl;
+            std::cout << std::left << std::setw(10) << "Size" << std::setw(10) << "Op";
+            for (const auto& impl : impls) {
+                std::cout << std::setw(16) << impl.name;
+            }
+            std::cout << std::right << std::endl;
+
+            for (size_t size : sizes) {
+                const auto message = generateRandomBytes(size);
+                for (size_t i = 1; i < impls.size(); ++i) {
+                    verifyAgainstEvp(impls[0], impls[i], cipherName, message);
+                }
+                const size_t reps = std::max<size_t>(1, kBytesPerSample / size);
+                ByteBuffer ciphertext(size + 16);
+                const size_t ciphertextLen = impls[0].encrypt(message.data(), size, ciphertext.data()).first;
+                ByteBuffer out(size + 16);
+
+                for (bool encryptOp : {true, false}) {
+                    const std::string op = encryptOp ? "encrypt" : "decrypt";
+                    std::cout << std::left << std::setw(10) << formatBytes(size) << std::setw(10) << op << std::right;
+                    for (const auto& impl : impls) {
+                        auto [mean, stddev] = sampleThroughput(opts.timedIters, reps, size, [&] {
+                            return encryptOp ? impl.encrypt(message.data(), size, out.data()).second
+                                             : impl.decrypt(ciphertext.data(), ciphertextLen, out.data()).second;
+                        });
+                        std::cout << std::fixed << std::setprecision(2) << std::setw(12) << mean << "    ";
+                        csv << cipherName << "," << op << "," << impl.name << "," << size << ","
+                            << opts.timedIters << "," << std::fixed << std::setprecision(2) << mean << ","
+                            << stddev << "\n";
+                    }
+                    std::cout << std::endl;
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved kernel comparison to: results/kernel_results.csv" << std::endl;
+}
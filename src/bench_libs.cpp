@@ -0,0 +1,343 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <openssl/crypto.h>
+
+#include <dlfcn.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+extern char** environ;
+
+namespace {
+// message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {64, 1024, 16 * 1024, 1024 * 1024};
+
+// plaintext bytes processed per timed sample
+const size_t kBytesPerSample = 16 * 1024 * 1024;
+
+// a libcrypto to benchmark: the one the dynamic linker finds by default, or the one in `dir`
+struct LibraryBuild {
+    std::string label;
+    std::string dir; // empty: no LD_LIBRARY_PATH change
+};
+
+// "LABEL=DIR" or just "DIR" (labelled by the directory as given); the directory is made absolute,
+// since the worker resolves the shim's symlink and OPENSSL_MODULES without our working directory
+LibraryBuild parseLibraryBuild(const std::string& item) {
+    const auto eq = item.find('=');
+    if (eq == 0 || (eq != std::string::npos && eq + 1 == item.size())) {
+        throw std::invalid_argument("Expected LABEL=DIR or DIR in --libcrypto, got '" + item + "'");
+    }
+    const std::string label = eq == std::string::npos ? item : item.substr(0, eq);
+    const std::string dir = eq == std::string::npos ? item : item.substr(eq + 1);
+    char resolved[PATH_MAX];
+    if (!::realpath(dir.c_str(), resolved)) {
+        throw std::invalid_argument("--libcrypto directory " + dir + ": " + std::strerror(errno));
+    }
+    return {label, resolved};
+}
+
+// file the running process loaded libcrypto from, with symlinks resolved
+std::string loadedLibcryptoPath() {
+    Dl_info info{};
+    void* symbol = ::dlsym(RTLD_DEFAULT, "OpenSSL_version");
+    if (!symbol || ::dladdr(symbol, &info) == 0 || !info.dli_fname) {
+        return "unknown";
+    }
+    char resolved[PATH_MAX];
+    return ::realpath(info.dli_fname, resolved) ? resolved : info.dli_fname;
+}
+
+std::string selfExecutable() {
+    char path[4096];
+    const ssize_t n = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (n <= 0) {
+        throw std::runtime_error("Cannot resolve /proc/self/exe to re-run the benchmark");
+    }
+    path[n] = '\0';
+    return path;
+}
+
+// output of one worker run, keyed by (cipher, operation, size)
+struct WorkerReport {
+    std::string version;
+    std::string library;
+    std::map<std::tuple<std::string, std::string, size_t>, std::pair<double, double>> results;
+};
+
+// A temporary directory holding only a libcrypto.so.3 symlink into a build's directory. Putting
+// the shim rather than the build directory on LD_LIBRARY_PATH keeps the other libraries there (an
+// older libstdc++ in a toolchain prefix, say) from replacing the system ones in the worker.
+class LibraryShim {
+public:
+    explicit LibraryShim(const std::string& dir) {
+        const std::string target = dir + "/libcrypto.so.3";
+        if (!pathExists(target)) {
+            throw std::runtime_error("no libcrypto.so.3 in " + dir);
+        }
+        char pattern[] = "/tmp/bench-libcrypto-XXXXXX";
+        if (!::mkdtemp(pattern)) {
+            throw std::runtime_error(std::string("mkdtemp failed: ") + std::strerror(errno));
+        }
+        path_ = pattern;
+        if (::symlink(target.c_str(), (path_ + "/libcrypto.so.3").c_str()) != 0) {
+            const std::string reason = std::strerror(errno);
+            ::rmdir(path_.c_str());
+            throw std::runtime_error("symlink failed: " + reason);
+        }
+    }
+    ~LibraryShim() {
+        ::unlink((path_ + "/libcrypto.so.3").c_str());
+        ::rmdir(path_.c_str());
+    }
+    LibraryShim(const LibraryShim&) = delete;
+    LibraryShim& operator=(const LibraryShim&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+// run this binary in worker mode with `build`'s libcrypto first on LD_LIBRARY_PATH (and its
+// provider modules, if the build has an ossl-modules directory) and parse what it prints
+WorkerReport runWorker(const LibraryBuild& build, const std::vector<std::string>& workerArgs) {
+    std::unique_ptr<LibraryShim> shim;
+    if (!build.dir.empty()) {
+        shim = std::make_unique<LibraryShim>(build.dir);
+    }
+    const bool ownModules = !build.dir.empty() && pathExists(build.dir + "/ossl-modules");
+    std::vector<std::string> env;
+    std::string libraryPath;
+    for (char** e = environ; *e; ++e) {
+        if (std::strncmp(*e, "LD_LIBRARY_PATH=", 16) == 0) {
+            libraryPath = *e + 16;
+        } else if (!(ownModules && std::strncmp(*e, "OPENSSL_MODULES=", 16) == 0)) {
+            env.emplace_back(*e);
+        }
+    }
+    if (shim) {
+        libraryPath = libraryPath.empty() ? shim->path() : shim->path() + ":" + libraryPath;
+    }
+    if (ownModules) {
+        env.push_back("OPENSSL_MODULES=" + build.dir + "/ossl-modules");
+    }
+    if (!libraryPath.empty()) {
+        env.push_back("LD_LIBRARY_PATH=" + libraryPath);
+    }
+    std::vector<char*> envp;
+    for (auto& entry : env) {
+        envp.push_back(entry.data());
+    }
+    envp.push_back(nullptr);
+    std::vector<std::string> args = workerArgs;
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        throw std::runtime_error(std::string("pipe failed: ") + std::strerror(errno));
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+    pid_t pid = 0;
+    const int rc = ::posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[1]);
+    if (rc != 0) {
+        ::close(fds[0]);
+        throw std::runtime_error(std::string("posix_spawn failed: ") + std::strerror(rc));
+    }
+
+    std::string output;
+    char buffer[4096];
+    for (;;) {
+        const ssize_t n = ::read(fds[0], buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        output.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fds[0]);
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("worker for " + build.label + " failed (see its error output above)");
+    }
+
+    WorkerReport report;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        std::string tag;
+        std::getline(fields, tag, ',');
+        if (tag == "LIBRARY") {
+            std::getline(fields, report.version, ',');
+            std::getline(fields, report.library);
+        } else if (tag == "RESULT") {
+            std::string cipher, op, size, mean, stddev;
+            std::getline(fields, cipher, ',');
+            std::getline(fields, op, ',');
+            std::getline(fields, size, ',');
+            std::getline(fields, mean, ',');
+            std::getline(fields, stddev);
+            report.results[{cipher, op, std::stoull(size)}] = {std::stod(mean), std::stod(stddev)};
+        }
+    }
+    if (report.results.empty()) {
+        throw std::runtime_error("worker for " + build.label + " reported no results");
+    }
+    return report;
+}
+
+// --lib-worker: the measurement run inside each child, printed as LIBRARY/RESULT lines
+void runWorkerMeasurements(const BenchOptions& opts) {
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+    std::cout << "LIBRARY," << OpenSSL_version(OPENSSL_VERSION) << "," << loadedLibcryptoPath() << std::endl;
+    for (CipherType cipher : opts.ciphers) {
+        const size_t block = cipherBlockSize(cipher);
+        for (size_t size : sizes) {
+            const auto message = generateRandomBytes(size);
+            ByteBuffer ciphertext(size + block);
+            const size_t ciphertextLen = encrypt_into_with_timing(cipher, message.data(), size, ciphertext.data(), key, iv).first;
+            ByteBuffer out(size + block);
+            const size_t reps = std::max<size_t>(1, kBytesPerSample / size);
+            for (bool encryptOp : {true, false}) {
+                auto [mean, stddev] = sampleThroughput(opts.timedIters, reps, size, [&] {
+                    return encryptOp ? encrypt_into_with_timing(cipher, message.data(), size, out.data(), key, iv).second
+                                     : decrypt_into_with_timing(cipher, ciphertext.data(), ciphertextLen, out.data(), key, iv).second;
+                });
+                std::cout << "RESULT," << cipherTypeToString(cipher) << "," << (encryptOp ? "encrypt" : "decrypt")
+                          << "," << size << "," << std::fixed << std::setprecision(3) << mean << "," << stddev
+                          << std::endl;
+            }
+        }
+    }
+}
+}
+
+void runLibraryComparison(const BenchOptions& opts) {
+    if (opts.libWorker) {
+        runWorkerMeasurements(opts);
+        return;
+    }
+    std::vector<LibraryBuild> builds = {{"system", ""}};
+    for (const auto& item : opts.libcryptoDirs) {
+        builds.push_back(parseLibraryBuild(item));
+    }
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+
+    std::vector<std::string> workerArgs = {selfExecutable(), "--mode=libs", "--lib-worker",
+                                           "--iterations=" + std::to_string(opts.timedIters)};
+    std::string ciphers;
+    for (CipherType cipher : opts.ciphers) {
+        ciphers += (ciphers.empty() ? "" : ",") + cipherTypeToString(cipher);
+    }
+    workerArgs.push_back("--ciphers=" + ciphers);
+    std::string sizeList;
+    for (size_t size : sizes) {
+        sizeList += (sizeList.empty() ? "" : ",") + std::to_string(size);
+    }
+    workerArgs.push_back("--sizes=" + sizeList);
+
+    // one worker per build, in turn, so they never compete for the CPU
+    std::vector<std::pair<LibraryBuild, WorkerReport>> reports;
+    for (const auto& build : builds) {
+        std::cout << "Running worker for " << build.label
+                  << (build.dir.empty() ? "" : " (libcrypto from " + build.dir + ")") << "..." << std::endl;
+        try {
+            WorkerReport report = runWorker(build, workerArgs);
+            std::cout << "  " << report.version << " from " << report.library << std::endl;
+            reports.emplace_back(build, std::move(report));
+        } catch (const std::exception& ex) {
+            std::cout << "  Skipping " << build.label << ": " << ex.what() << std::endl;
+        }
+    }
+    if (reports.empty()) {
+        throw std::runtime_error("No libcrypto build produced results");
+    }
+    // a build whose worker ended up with a library already measured (an RPATH or the directory
+    // contents can override LD_LIBRARY_PATH) would only repeat that library under another label
+    for (size_t i = 1; i < reports.size();) {
+        auto same = std::find_if(reports.begin(), reports.begin() + i, [&](const auto& earlier) {
+            return earlier.second.library == reports[i].second.library;
+        });
+        if (same != reports.begin() + i) {
+            std::cout << "Dropping " << reports[i].first.label << ": it loaded the same libcrypto ("
+                      << reports[i].second.library << ") as " << same->first.label << std::endl;
+            reports.erase(reports.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+
+    auto csv = openResultsFile("libcrypto_results.csv");
+    csv << "Cipher,Operation,Size(Bytes),Build,Version,Library,Runs,Throughput(MB/s),StdDev(MB/s),SpeedupVs"
+        << reports.front().first.label << "\n";
+
+    std::cout << "\n--- Throughput per libcrypto build (MB/s, speedup vs " << reports.front().first.label
+              << ") ---" << std::endl;
+    std::cout << std::left << std::setw(10) << "Cipher" << std::setw(10) << "Size" << std::setw(10) << "Op";
+    for (const auto& [build, report] : reports) {
+        std::cout << std::setw(24) << build.label;
+    }
+    std::cout << std::right << std::endl;
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        for (size_t size : sizes) {
+            for (const std::string op : {"encrypt", "decrypt"}) {
+                const auto key = std::make_tuple(cipherName, op, size);
+                std::cout << std::left << std::setw(10) << cipherName << std::setw(10) << formatBytes(size)
+                          << std::setw(10) << op << std::right;
+                const auto reference = reports.front().second.results.find(key);
+                for (const auto& [build, report] : reports) {
+                    const auto it = report.results.find(key);
+                    if (it == report.results.end() || reference == reports.front().second.results.end()) {
+                        std::cout << std::setw(12) << "n/a" << std::string(12, ' ');
+                        continue;
+                    }
+                    const auto [mean, stddev] = it->second;
+                    const double speedup = mean / reference->second.first;
+                    std::cout << std::fixed << std::setprecision(2) << std::setw(12) << mean << " (" << std::setw(5)
+                              << speedup << "x)   ";
+                    csv << cipherName << "," << op << "," << size << "," << build.label << "," << report.version
+                        << "," << report.library << "," << opts.timedIters << "," << std::fixed
+                        << std::setprecision(2) << mean << "," << stddev << "," << std::setprecision(3) << speedup
+                        << "\n";
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+    std::cout << "\nSaved libcrypto comparison to: results/libcrypto_results.csv" << std::endl;
+}
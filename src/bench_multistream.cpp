@@ -0,0 +1,95 @@
+#include "bench_modes.hpp"
+#include "aes_kernels.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {64, 256, 1024, 4096, 16384, 65536};
+
+// lane counts of the interleaved kernel; 1 lane is the same kernel without interleaving
+const std::vector<int> kLaneCounts = {1, 2, 4, 6, 8};
+
+// message bytes per timed sample
+const size_t kBytesPerSample = 8 * 1024 * 1024;
+}
+
+void runMultiStreamBenchmark(const BenchOptions& opts) {
+    if (std::find(opts.ciphers.begin(), opts.ciphers.end(), CipherType::AES) == opts.ciphers.end()) {
+        std::cout << "Multi-stream CBC is implemented for AES-128 only; nothing to do for the selected ciphers"
+                  << std::endl;
+        return;
+    }
+    const bool aesni = aesniAvailable();
+    std::cout << "AES-NI kernel: " << (aesni ? "available" : "unavailable, interleaved rows use EVP (encrypt_batch)")
+              << std::endl;
+    if (aesni && !aesKernelsOptimised()) {
+        std::cout << "Warning: the in-tree kernels were built without optimisation; the interleaved rows are not "
+                     "comparable (rebuild with -DCMAKE_BUILD_TYPE=Release)" << std::endl;
+    }
+
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const size_t count = static_cast<size_t>(opts.batchSize);
+    const auto key = generateRandomBytes(16);
+
+    auto csv = openResultsFile("multistream_results.csv");
+    csv << "Cipher,MessageSize(Bytes),Messages,Variant,Lanes,Runs,Throughput(MB/s),StdDev(MB/s)\n";
+
+    for (size_t size : sizes) {
+        const size_t outputSize = paddedLength(CipherType::AES, size);
+        const auto inputs = generateRandomBytes(count * size);
+        const auto ivBytes = generateRandomBytes(count * 16);
+        ByteBuffer outputs(count * outputSize);
+        std::vector<BatchItem> items(count);
+        std::vector<std::vector<unsigned char>> ivs;
+        for (size_t i = 0; i < count; ++i) {
+            items[i].input = ByteSpan(inputs.data() + i * size, size);
+            items[i].iv = ivBytes.data() + i * 16;
+            items[i].out = outputs.data() + i * outputSize;
+            ivs.emplace_back(ivBytes.begin() + i * 16, ivBytes.begin() + (i + 1) * 16);
+        }
+        const size_t totalBytes = count * size;
+        const size_t reps = std::max<size_t>(1, kBytesPerSample / totalBytes);
+
+        // every lane count must reproduce the serial EVP ciphertext exactly
+        for (int lanes : kLaneCounts) {
+            aes128_cbc_encrypt_interleaved(items, key, lanes);
+            for (size_t i = 0; i < count; ++i) {
+                if (ByteSpan(items[i].out, items[i].outLength) != encrypt(CipherType::AES, items[i].input, key, ivs[i])) {
+                    throw std::runtime_error("Interleaved AES-CBC mismatch with " + std::to_string(lanes)
+                                             + " lanes, message " + std::to_string(i));
+                }
+            }
+        }
+
+        std::cout << "\n--- Multi-stream AES-128-CBC encrypt: " << count << " x " << formatBytes(size) << " ---"
+                  << std::endl;
+        std::cout << std::left << std::setw(26) << "Variant" << "Throughput (MB/s)" << std::right << std::endl;
+        auto report = [&](const std::string& variant, int lanes, std::pair<double, double> result) {
+            std::cout << std::left << std::setw(26) << variant << std::right << std::fixed << std::setprecision(2)
+                      << result.first << " +/- " << result.second << std::endl;
+            csv << "AES," << size << "," << count << "," << variant << "," << lanes << "," << opts.timedIters
+                << "," << std::fixed << std::setprecision(2) << result.first << "," << result.second << "\n";
+        };
+
+        report("serial encrypt", 1, sampleWallThroughput(opts.timedIters, reps, totalBytes, [&] {
+            for (size_t i = 0; i < count; ++i) {
+                ByteBuffer out = encrypt(CipherType::AES, items[i].input, key, ivs[i]);
+            }
+        }));
+        report("encrypt_batch (EVP)", 1, sampleWallThroughput(opts.timedIters, reps, totalBytes, [&] {
+            encrypt_batch(CipherType::AES, items, key);
+        }));
+        for (int lanes : kLaneCounts) {
+            report("interleaved x" + std::to_string(lanes), lanes, sampleWallThroughput(opts.timedIters, reps, totalBytes, [&] {
+                aes128_cbc_encrypt_interleaved(items, key, lanes);
+            }));
+        }
+    }
+    std::cout << "\nSaved multi-stream results to: results/multistream_results.csv" << std::endl;
+}
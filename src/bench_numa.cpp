@@ -0,0 +1,152 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+// plaintext bytes each thread encrypts per timed sample
+const size_t kBytesPerThreadSample = 16 * 1024 * 1024;
+
+// 1, 2, 4, ... up to the CPUs of the node, unless the user gave --threads
+std::vector<int> threadCountsForNode(const std::vector<int>& requested, size_t nodeCpus) {
+    std::vector<int> counts;
+    for (int t : defaultThreadCounts(requested)) {
+        if (static_cast<size_t>(t) <= nodeCpus) {
+            counts.push_back(t);
+        }
+    }
+    if (counts.empty() || (requested.empty() && static_cast<size_t>(counts.back()) != nodeCpus)) {
+        counts.push_back(static_cast<int>(nodeCpus));
+    }
+    return counts;
+}
+
+struct PlacementResult {
+    double mean;
+    double stddev;
+    int actualNode; // node get_mempolicy reports for the first buffer
+    CellResources resources;
+};
+
+// throughput with `threads` threads on `cpus` encrypting DRAM-resident buffers bound to memNode
+PlacementResult measurePlacement(CipherType cipher, int threads, const std::vector<int>& cpus, int memNode,
+                                 const BenchOptions& opts, const std::vector<unsigned char>& message,
+                                 const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv) {
+    const size_t messageSize = message.size();
+    const size_t outputSize = messageSize + cipherBlockSize(cipher);
+    BufferLayout layout = opts.layout;
+    layout.numaNode = memNode;
+
+    ResourceMeter meter;
+    std::vector<std::unique_ptr<BufferRing>> rings;
+    for (int t = 0; t < threads; ++t) {
+        rings.push_back(std::make_unique<BufferRing>(messageSize, outputSize, 4 * lastLevelCacheSize() / threads, layout));
+        rings.back()->fillInputs(message.data(), messageSize);
+    }
+    const size_t messagesPerThread = std::max<size_t>(1, kBytesPerThreadSample / messageSize);
+    std::vector<size_t> cursors(threads, 0);
+    auto work = [&](int t) {
+        BufferRing& ring = *rings[t];
+        for (size_t m = 0; m < messagesPerThread; ++m, ++cursors[t]) {
+            encrypt_into_with_timing(cipher, ring.input(cursors[t]), messageSize, ring.output(cursors[t]), key, iv);
+        }
+    };
+    runParallel(threads, work, cpus);
+
+    std::vector<double> throughputs;
+    for (int i = 0; i < opts.timedIters; ++i) {
+        double ms = runParallel(threads, work, cpus);
+        double bytes = static_cast<double>(messagesPerThread) * messageSize * threads;
+        throughputs.push_back((bytes / 1.0e6) / (ms / 1000.0));
+    }
+    auto [mean, stddev] = meanAndStddev(throughputs);
+    return {mean, stddev, nodeOfAddress(rings[0]->input(0)), meter.finish()};
+}
+}
+
+void runNumaBenchmark(const BenchOptions& opts) {
+    const auto nodes = detectNumaNodes();
+    std::cout << "NUMA nodes:";
+    for (const auto& node : nodes) {
+        std::cout << " node" << node.id << " (" << node.cpus.size() << " CPUs)";
+    }
+    std::cout << std::endl;
+    if (nodes.size() == 1) {
+        std::cout << "Only one NUMA node: just local placement can be measured." << std::endl;
+    }
+
+    if (opts.layout.numaNode >= 0 &&
+        std::none_of(nodes.begin(), nodes.end(), [&](const NumaNode& n) { return n.id == opts.layout.numaNode; })) {
+        throw std::runtime_error("No such NUMA node: " + std::to_string(opts.layout.numaNode));
+    }
+
+    // CPU side: the --cpu-node, else every node with CPUs we may use
+    std::vector<std::pair<int, std::vector<int>>> cpuNodes;
+    for (const auto& node : nodes) {
+        if (opts.cpuNode >= 0 && node.id != opts.cpuNode) {
+            continue;
+        }
+        try {
+            cpuNodes.push_back({node.id, cpusForNode(node.id)});
+        } catch (const std::runtime_error&) {
+            // memory-only node or outside our affinity mask
+        }
+    }
+    if (cpuNodes.empty()) {
+        throw std::runtime_error("No usable CPUs on the selected NUMA node(s)");
+    }
+
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+    const auto message = generateRandomBytes(opts.messageSize);
+
+    auto csv = openResultsFile("numa_results.csv");
+    csv << "Cipher,Threads,CpuNode,MemNode,ActualMemNode,Placement,MessageSize(Bytes),Runs,Throughput(MB/s),StdDev(MB/s),RelativeToLocal" << kResourceCsvHeader << "\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        std::cout << "\n--- NUMA placement: " << cipherName << ", " << opts.messageSize << " B messages ---" << std::endl;
+        std::cout << std::left << std::setw(9) << "Threads" << std::setw(9) << "CPU" << std::setw(9) << "Memory"
+                  << std::setw(9) << "Where" << std::setw(24) << "Throughput (MB/s)" << "vs local" << std::right << std::endl;
+
+        for (const auto& [cpuNode, cpus] : cpuNodes) {
+            // memory side: local first, then the --mem-node or every other node
+            std::vector<int> memNodes = {cpuNode};
+            for (const auto& node : nodes) {
+                if (node.id != cpuNode && (opts.layout.numaNode < 0 || node.id == opts.layout.numaNode)) {
+                    memNodes.push_back(node.id);
+                }
+            }
+
+            for (int threads : threadCountsForNode(opts.threadCounts, cpus.size())) {
+                double local = 0.0;
+                for (int memNode : memNodes) {
+                    auto r = measurePlacement(cipher, threads, cpus, memNode, opts, message, key, iv);
+                    if (memNode == cpuNode) {
+                        local = r.mean;
+                    }
+                    const char* placement = memNode == cpuNode ? "local" : "remote";
+                    std::cout << std::left << std::setw(9) << threads << std::setw(9) << ("node" + std::to_string(cpuNode))
+                              << std::setw(9) << ("node" + std::to_string(r.actualNode)) << std::setw(9) << placement
+                              << std::right << std::fixed << std::setprecision(2) << std::setw(10) << r.mean
+                              << " +/- " << std::setw(8) << r.stddev << "   " << std::setprecision(3)
+                              << r.mean / local << "   " << formatResources(r.resources) << std::endl;
+                    csv << cipherName << "," << threads << "," << cpuNode << "," << memNode << "," << r.actualNode << ","
+                        << placement << "," << opts.messageSize << "," << opts.timedIters << ","
+                        << std::fixed << std::setprecision(2) << r.mean << "," << r.stddev << ","
+                        << std::setprecision(3) << r.mean / local;
+                    writeResourceCsv(csv, r.resources);
+                    csv << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved NUMA results to: results/numa_results.csv" << std::endl;
+}
@@ -0,0 +1,428 @@
+#include "bench_options.hpp"
+
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+// largest --mix packet: bench_imix keeps a ciphertext of every size per IV (kIvPoolSize of them)
+const size_t kMaxPacketSize = 64 * 1024;
+
+// largest sum of --mix weights: a packet stream holds at least one entry per unit of weight
+const long long kMaxMixWeight = 1000000;
+
+// split "--name=value" into name and value (value empty if there is no '=')
+std::pair<std::string, std::string> splitOption(const std::string& arg) {
+    auto eq = arg.find('=');
+    if (eq == std::string::npos) {
+        return {arg, ""};
+    }
+    return {arg.substr(0, eq), arg.substr(eq + 1)};
+}
+
+int parsePositiveInt(const std::string& name, const std::string& value) {
+    try {
+        size_t used = 0;
+        int parsed = std::stoi(value, &used);
+        if (used == value.size() && parsed > 0) {
+            return parsed;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Expected a positive integer for " + name + ", got '" + value + "'");
+}
+
+// split a comma separated list ("a,b,c")
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    size_t pos = 0;
+    while (pos <= value.size()) {
+        size_t comma = value.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = value.size();
+        }
+        if (comma > pos) {
+            items.push_back(value.substr(pos, comma - pos));
+        }
+        pos = comma + 1;
+    }
+    return items;
+}
+
+BenchMode parseBenchMode(const std::string& value) {
+    if (value == "suite") return BenchMode::SUITE;
+    if (value == "wss") return BenchMode::WSS;
+    if (value == "roofline") return BenchMode::ROOFLINE;
+    if (value == "alignment") return BenchMode::ALIGNMENT;
+    if (value == "numa") return BenchMode::NUMA;
+    if (value == "stream") return BenchMode::STREAM;
+    if (value == "alloc") return BenchMode::ALLOC;
+    if (value == "zerofill") return BenchMode::ZEROFILL;
+    if (value == "inplace") return BenchMode::INPLACE;
+    if (value == "gather") return BenchMode::GATHER;
+    if (value == "batch") return BenchMode::BATCH;
+    if (value == "multistream") return BenchMode::MULTISTREAM;
+    if (value == "kernels") return BenchMode::KERNELS;
+    if (value == "backends") return BenchMode::BACKENDS;
+    if (value == "fetch") return BenchMode::FETCH;
+    if (value == "contention") return BenchMode::CONTENTION;
+    if (value == "providers") return BenchMode::PROVIDERS;
+    if (value == "libs") return BenchMode::LIBS;
+    if (value == "session") return BenchMode::SESSION;
+    if (value == "tenants") return BenchMode::TENANTS;
+    if (value == "replay") return BenchMode::REPLAY;
+    if (value == "imix") return BenchMode::IMIX;
+    throw std::invalid_argument("Unknown --mode: '" + value + "'");
+}
+
+int parseNonNegativeInt(const std::string& name, const std::string& value) {
+    try {
+        size_t used = 0;
+        int parsed = std::stoi(value, &used);
+        if (used == value.size() && parsed >= 0) {
+            return parsed;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Expected a non-negative integer for " + name + ", got '" + value + "'");
+}
+
+PageSize parsePageSize(const std::string& value) {
+    for (PageSize pages : {PageSize::BASE, PageSize::THP, PageSize::HUGE_2MB, PageSize::HUGE_1GB}) {
+        if (pageSizeToString(pages) == value) {
+            return pages;
+        }
+    }
+    throw std::invalid_argument("Unknown --page-size: '" + value + "' (expected base, thp, 2m or 1g)");
+}
+
+size_t parseOffset(const std::string& name, const std::string& value) {
+    try {
+        size_t used = 0;
+        unsigned long parsed = std::stoul(value, &used);
+        if (used == value.size() && parsed < 4096) {
+            return parsed;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Expected an offset between 0 and 4095 for " + name + ", got '" + value + "'");
+}
+
+double parseNonNegativeDouble(const std::string& name, const std::string& value) {
+    try {
+        size_t used = 0;
+        double parsed = std::stod(value, &used);
+        if (used == value.size() && parsed >= 0.0) {
+            return parsed;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Expected a non-negative number for " + name + ", got '" + value + "'");
+}
+
+CpuCacheMode parseCpuCacheMode(const std::string& value) {
+    if (value == "warm") return CpuCacheMode::WARM;
+    if (value == "flush") return CpuCacheMode::FLUSH;
+    if (value == "rotate") return CpuCacheMode::ROTATE;
+    throw std::invalid_argument("Unknown --cpu-cache mode: '" + value + "' (expected warm, flush or rotate)");
+}
+}
+
+size_t parseByteSize(const std::string& name, const std::string& value) {
+    try {
+        size_t used = 0;
+        unsigned long long parsed = std::stoull(value, &used);
+        std::string suffix = value.substr(used);
+        unsigned long long scale = 1;
+        if (suffix == "K" || suffix == "k") scale = 1024ULL;
+        else if (suffix == "M" || suffix == "m") scale = 1024ULL * 1024;
+        else if (suffix == "G" || suffix == "g") scale = 1024ULL * 1024 * 1024;
+        else if (!suffix.empty()) scale = 0;
+        // reject sizes whose scaled value does not fit in size_t instead of letting them wrap
+        if (scale != 0 && parsed > 0 && parsed <= std::numeric_limits<size_t>::max() / scale) {
+            return static_cast<size_t>(parsed * scale);
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Expected a byte size (e.g. 4096, 64K, 2M) for " + name + ", got '" + value + "'");
+}
+
+std::string benchModeToString(BenchMode mode) {
+    switch (mode) {
+        case BenchMode::SUITE:
+            return "suite";
+        case BenchMode::WSS:
+            return "wss";
+        case BenchMode::ROOFLINE:
+            return "roofline";
+        case BenchMode::ALIGNMENT:
+            return "alignment";
+        case BenchMode::NUMA:
+            return "numa";
+        case BenchMode::STREAM:
+            return "stream";
+        case BenchMode::ALLOC:
+            return "alloc";
+        case BenchMode::ZEROFILL:
+            return "zerofill";
+        case BenchMode::INPLACE:
+            return "inplace";
+        case BenchMode::GATHER:
+            return "gather";
+        case BenchMode::BATCH:
+            return "batch";
+        case BenchMode::MULTISTREAM:
+            return "multistream";
+        case BenchMode::KERNELS:
+            return "kernels";
+        case BenchMode::BACKENDS:
+            return "backends";
+        case BenchMode::FETCH:
+            return "fetch";
+        case BenchMode::CONTENTION:
+            return "contention";
+        case BenchMode::PROVIDERS:
+            return "providers";
+        case BenchMode::LIBS:
+            return "libs";
+        case BenchMode::SESSION:
+            return "session";
+        case BenchMode::TENANTS:
+            return "tenants";
+        case BenchMode::REPLAY:
+            return "replay";
+        case BenchMode::IMIX:
+            return "imix";
+        default:
+            return "unknown";
+    }
+}
+
+std::string cpuCacheModeToString(CpuCacheMode mode) {
+    switch (mode) {
+        case CpuCacheMode::WARM:
+            return "warm";
+        case CpuCacheMode::FLUSH:
+            return "flush";
+        case CpuCacheMode::ROTATE:
+            return "rotate";
+        default:
+            return "unknown";
+    }
+}
+
+BenchOptions parseArgs(int argc, char** argv) {
+    BenchOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        auto [name, value] = splitOption(argv[i]);
+        if (name == "-h" || name == "--help") {
+            opts.showHelp = true;
+        } else if (name == "--mode") {
+            opts.mode = parseBenchMode(value);
+        } else if (name == "--ciphers") {
+            opts.ciphers.clear();
+            for (const auto& item : splitList(value)) {
+                opts.ciphers.push_back(cipherTypeFromString(item));
+            }
+            if (opts.ciphers.empty()) {
+                throw std::invalid_argument("--ciphers needs at least one cipher");
+            }
+        } else if (name == "--threads") {
+            opts.threadCounts.clear();
+            for (const auto& item : splitList(value)) {
+                opts.threadCounts.push_back(parsePositiveInt(name, item));
+            }
+        } else if (name == "--sizes") {
+            opts.datasetSizes.clear();
+            for (const auto& item : splitList(value)) {
+                opts.datasetSizes.push_back(parseByteSize(name, item));
+            }
+        } else if (name == "--fragments") {
+            opts.fragmentCounts.clear();
+            for (const auto& item : splitList(value)) {
+                opts.fragmentCounts.push_back(parsePositiveInt(name, item));
+            }
+        } else if (name == "--batch-size") {
+            opts.batchSize = parsePositiveInt(name, value);
+        } else if (name == "--backends") {
+            opts.backends.clear();
+            for (const auto& item : splitList(value)) {
+                opts.backends.push_back(backendTypeFromString(item));
+            }
+            if (opts.backends.empty()) {
+                throw std::invalid_argument("--backends needs at least one backend");
+            }
+        } else if (name == "--providers") {
+            opts.providers = splitList(value);
+            if (opts.providers.empty()) {
+                throw std::invalid_argument("--providers needs at least one provider name");
+            }
+        } else if (name == "--properties") {
+            opts.cipherProperties = value;
+        } else if (name == "--libcrypto") {
+            opts.libcryptoDirs = splitList(value);
+            if (opts.libcryptoDirs.empty()) {
+                throw std::invalid_argument("--libcrypto needs at least one directory");
+            }
+        } else if (name == "--lib-worker") {
+            opts.libWorker = true;
+        } else if (name == "--keys") {
+            opts.keyCounts.clear();
+            for (const auto& item : splitList(value)) {
+                opts.keyCounts.push_back(parsePositiveInt(name, item));
+            }
+        } else if (name == "--key-cache") {
+            opts.keyCacheSize = parsePositiveInt(name, value);
+        } else if (name == "--zipf") {
+            opts.zipfExponent = parseNonNegativeDouble(name, value);
+        } else if (name == "--trace") {
+            if (value.empty()) {
+                throw std::invalid_argument("--trace needs a file name");
+            }
+            opts.tracePath = value;
+        } else if (name == "--pacing") {
+            if (value == "full") {
+                opts.pacing = ReplayPacing::FULL;
+            } else if (value == "recorded") {
+                opts.pacing = ReplayPacing::RECORDED;
+            } else {
+                throw std::invalid_argument("Unknown --pacing: '" + value + "' (expected full or recorded)");
+            }
+        } else if (name == "--mixes") {
+            opts.packetMixes = splitList(value);
+            if (opts.packetMixes.empty()) {
+                throw std::invalid_argument("--mixes needs at least one mix name");
+            }
+        } else if (name == "--mix") {
+            opts.customMix.clear();
+            long long totalWeight = 0;
+            for (const auto& item : splitList(value)) {
+                const auto colon = item.find(':');
+                if (colon == std::string::npos) {
+                    throw std::invalid_argument("Expected SIZE:WEIGHT entries for --mix, got '" + item + "'");
+                }
+                const size_t size = parseByteSize(name, item.substr(0, colon));
+                if (size == 0 || size > kMaxPacketSize) {
+                    throw std::invalid_argument("--mix packet sizes must be 1 to 64K bytes, got '" + item + "'");
+                }
+                const int weight = parsePositiveInt(name, item.substr(colon + 1));
+                totalWeight += weight;
+                if (totalWeight > kMaxMixWeight) {
+                    throw std::invalid_argument("--mix weights may add up to at most 1000000, got '" + value + "'");
+                }
+                opts.customMix.emplace_back(size, weight);
+            }
+            if (opts.customMix.empty()) {
+                throw std::invalid_argument("--mix needs at least one SIZE:WEIGHT entry");
+            }
+        } else if (name == "--message-size") {
+            opts.messageSize = parseByteSize(name, value);
+        } else if (name == "--page-size") {
+            opts.layout.pageSize = parsePageSize(value);
+        } else if (name == "--input-offset") {
+            opts.layout.inputOffset = parseOffset(name, value);
+        } else if (name == "--output-offset") {
+            opts.layout.outputOffset = parseOffset(name, value);
+        } else if (name == "--cpu-node") {
+            opts.cpuNode = parseNonNegativeInt(name, value);
+        } else if (name == "--mem-node") {
+            opts.layout.numaNode = parseNonNegativeInt(name, value);
+        } else if (name == "--verify") {
+            if (value == "full") {
+                opts.verify = VerifyMode::FULL;
+            } else if (value == "digest") {
+                opts.verify = VerifyMode::DIGEST;
+            } else {
+                throw std::invalid_argument("Unknown --verify mode: '" + value + "' (expected full or digest)");
+            }
+        } else if (name == "--digest") {
+            if (value.empty()) {
+                throw std::invalid_argument("--digest needs a digest name");
+            }
+            opts.digestName = value;
+        } else if (name == "--stream-size") {
+            opts.streamSize = parseByteSize(name, value);
+        } else if (name == "--chunk-size") {
+            opts.chunkSize = parseByteSize(name, value);
+        } else if (name == "--strict-alloc") {
+            opts.strictAlloc = true;
+        } else if (name == "--iterations") {
+            opts.timedIters = parsePositiveInt(name, value);
+        } else if (name == "--cold-page-cache") {
+            opts.coldPageCache = true;
+        } else if (name == "--cpu-cache") {
+            opts.cpuCache = parseCpuCacheMode(value);
+        } else {
+            throw std::invalid_argument("Unknown option: " + std::string(argv[i]));
+        }
+    }
+    return opts;
+}
+
+void printUsage(const std::string& program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "\n"
+              << "Options:\n"
+              << "  -h, --help              show this help and exit\n"
+              << "  --mode=MODE             suite (default): per-file encrypt/decrypt timings\n"
+              << "                          wss: working-set sweep across L1/L2/L3 and DRAM\n"
+              << "                          roofline: cipher throughput vs memcpy/triad bandwidth\n"
+              << "                          alignment: page size x buffer misalignment sweep\n"
+              << "                          numa: local vs remote NUMA buffer placement\n"
+              << "                          stream: constant-memory streaming with digest verification\n"
+              << "                          alloc: OpenSSL and C++ allocations per operation per API\n"
+              << "                          zerofill: cost of zeroing output buffers before encrypting\n"
+              << "                          inplace: in-place vs out-of-place encrypt/decrypt\n"
+              << "                          gather: scatter/gather encryption vs copy-then-encrypt\n"
+              << "                          batch: batched small messages vs one call per message\n"
+              << "                          multistream: interleaved AES-CBC over 1-8 messages vs serial\n"
+              << "                          kernels: EVP vs in-tree AES-NI/VAES AES-128/256 CBC and CTR\n"
+              << "                          backends: one CBC workload through each crypto backend\n"
+              << "                          fetch: cipher init cost, implicit vs pre-fetched EVP_CIPHER\n"
+              << "                          contention: short-operation throughput vs threads, with mitigations\n"
+              << "                          providers: default vs FIPS vs legacy (vs --providers) matrix\n"
+              << "                          libs: system libcrypto vs the --libcrypto builds, one process each\n"
+              << "                          session: full init per message vs IV-only re-init (64B-16K)\n"
+              << "                          tenants: many keys with Zipf popularity via a keyed context cache\n"
+              << "                          replay: replay the --trace file, with latency percentiles\n"
+              << "                          imix: weighted packet-size mixes with per-size breakdowns\n"
+              << "  --ciphers=LIST          comma separated subset of aes,camellia,sm4 (default all)\n"
+              << "  --threads=LIST          thread counts for multi-threaded modes (default 1,2,4..all CPUs)\n"
+              << "  --sizes=LIST            extra in-memory datasets for the suite, e.g. 64M,1G\n"
+              << "                          (message sizes for the buffer, API and kernel modes)\n"
+              << "  --fragments=LIST        fragments per message for --mode=gather (default 1,4,16,64)\n"
+              << "  --batch-size=N          messages per batch for batch/multistream (default 256)\n"
+              << "  --backends=LIST         backends for --mode=backends: evp,evp-cipher,lowlevel,intree,\n"
+              << "                          afalg (default all)\n"
+              << "  --providers=LIST        OpenSSL providers to load, e.g. fips,base (default: default)\n"
+              << "  --properties=QUERY      property query for fetching ciphers, e.g. fips=yes\n"
+              << "  --libcrypto=LIST        libcrypto builds for --mode=libs as LABEL=DIR or DIR, e.g.\n"
+              << "                          3.3=/opt/openssl-3.3/lib64 (DIR goes first on LD_LIBRARY_PATH)\n"
+              << "  --keys=LIST             distinct keys for --mode=tenants (default 1,16,256,1024..64K)\n"
+              << "  --key-cache=N           keyed contexts cached by --mode=tenants (default 1024)\n"
+              << "  --zipf=S                Zipf exponent of key popularity, 0 = uniform (default 1.0)\n"
+              << "  --trace=FILE            trace for --mode=replay, one size,cipher,direction[,gap-us[,key-id]]\n"
+              << "                          message per line\n"
+              << "  --pacing=MODE           replay back to back (full, default) or at the recorded pacing\n"
+              << "  --mixes=LIST            built-in mixes for --mode=imix: imix,trimodal,jumbo (default all)\n"
+              << "  --mix=LIST              extra packet mix as SIZE:WEIGHT entries, e.g. 64:7,576:4,1500:1\n"
+              << "                          (packet sizes up to 64K, weights adding up to at most 1000000)\n"
+              << "  --message-size=BYTES    message size for sweep modes (default 4K)\n"
+              << "  --iterations=N          timed runs per benchmark cell (default 5)\n"
+              << "  --page-size=PAGES       pages behind benchmark buffers: base (default), thp,\n"
+              << "                          2m or 1g (MAP_HUGETLB, needs reserved huge pages)\n"
+              << "  --input-offset=N        start inputs N bytes past a cache-line boundary (default 0)\n"
+              << "  --output-offset=N       start outputs N bytes past a cache-line boundary (default 0)\n"
+              << "  --cpu-node=N            run worker threads only on the CPUs of NUMA node N\n"
+              << "  --mem-node=N            bind benchmark buffers to NUMA node N (mbind)\n"
+              << "  --cold-page-cache       drop each file from the page cache before every timed\n"
+              << "                          read, and report cold read+encrypt time\n"
+              << "  --strict-alloc          alloc mode: fail if an allocation-free API allocates\n"
+              << "  --verify=full|digest    suite check: byte compare (default) or digests on a helper thread\n"
+              << "  --digest=NAME           EVP digest for verification (default SHA256, e.g. BLAKE2b512)\n"
+              << "  --stream-size=BYTES     total stream length for --mode=stream (default 256M)\n"
+              << "  --chunk-size=BYTES      chunk size for --mode=stream (default 1M)\n"
+              << "  --cpu-cache=MODE        warm (default): re-use the same hot buffers\n"
+              << "                          flush: clflush input/output before every sample\n"
+              << "                          rotate: cycle through buffers larger than the LLC\n";
+}
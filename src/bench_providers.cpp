@@ -0,0 +1,124 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "cipher_cache.hpp"
+#include "crypto_utils.hpp"
+#include "providers.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {64, 1024, 16 * 1024, 1024 * 1024};
+
+// plaintext bytes processed per timed sample
+const size_t kBytesPerSample = 16 * 1024 * 1024;
+
+// a configuration that loaded, with its library context
+struct LoadedConfig {
+    ProviderConfig config;
+    ProviderContext context;
+};
+}
+
+void runProviderMatrix(const BenchOptions& opts) {
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    std::vector<ProviderConfig> configs = standardProviderConfigs();
+    if (!opts.providers.empty() || !opts.cipherProperties.empty()) {
+        configs.push_back({"custom", opts.providers, opts.cipherProperties});
+    }
+
+    std::vector<LoadedConfig> loaded;
+    for (const auto& config : configs) {
+        try {
+            loaded.push_back({config, ProviderContext(config)});
+            std::cout << "Configuration " << config.name << ": " << describeProviderConfig(config) << std::endl;
+        } catch (const std::runtime_error& ex) {
+            std::cout << "Skipping configuration " << config.name << ": " << ex.what() << std::endl;
+        }
+    }
+    if (loaded.empty()) {
+        throw std::runtime_error("No provider configuration could be loaded");
+    }
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+
+    auto csv = openResultsFile("provider_results.csv");
+    csv << "Cipher,Operation,Configuration,Providers,Provider,Size(Bytes),Runs,Throughput(MB/s),StdDev(MB/s),"
+           "Reference,Delta(%)\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const std::string name = evpCipherName(cipher);
+        // the configurations that implement this cipher, and the fetched cipher in each
+        std::vector<std::pair<LoadedConfig*, const evp_cipher_st*>> active;
+        for (auto& entry : loaded) {
+            if (const evp_cipher_st* fetched = entry.context.fetch(name)) {
+                active.emplace_back(&entry, fetched);
+            } else {
+                std::cout << "Skipping " << name << " under " << entry.config.name
+                          << ": no loaded provider implements it with this property query" << std::endl;
+            }
+        }
+        if (active.empty()) {
+            continue;
+        }
+        // deltas are against the first configuration that implements this cipher
+        const std::string referenceName = active.front().first->config.name;
+
+        std::cout << "\n--- " << name << " per provider configuration (MB/s, delta vs "
+                  << referenceName << ") ---" << std::endl;
+        std::cout << std::left << std::setw(10) << "Size" << std::setw(10) << "Op";
+        for (const auto& [entry, fetched] : active) {
+            std::cout << std::setw(26) << entry->config.name + " [" + ProviderContext::providerOf(fetched) + "]";
+        }
+        std::cout << std::right << std::endl;
+
+        for (size_t size : sizes) {
+            const auto message = generateRandomBytes(size);
+            const size_t block = cipherBlockSize(cipher);
+            ByteBuffer ciphertext(size + block);
+            const size_t ciphertextLen =
+                evp_encrypt_into_with_timing(active.front().second, message.data(), size, ciphertext.data(), key, iv).first;
+            ByteBuffer out(size + block);
+            // every implementation must agree with the first one
+            for (const auto& [entry, fetched] : active) {
+                const size_t n = evp_encrypt_into_with_timing(fetched, message.data(), size, out.data(), key, iv).first;
+                if (ByteSpan(out.data(), n) != ByteSpan(ciphertext.data(), ciphertextLen)) {
+                    throw std::runtime_error(name + " under " + entry->config.name + " differs from " + referenceName);
+                }
+            }
+            const size_t reps = std::max<size_t>(1, kBytesPerSample / size);
+
+            for (bool encryptOp : {true, false}) {
+                const std::string op = encryptOp ? "encrypt" : "decrypt";
+                std::cout << std::left << std::setw(10) << formatBytes(size) << std::setw(10) << op << std::right;
+                double reference = 0.0;
+                for (const auto& [entry, fetched] : active) {
+                    const evp_cipher_st* c = fetched;
+                    auto [mean, stddev] = sampleThroughput(opts.timedIters, reps, size, [&] {
+                        return encryptOp ? evp_encrypt_into_with_timing(c, message.data(), size, out.data(), key, iv).second
+                                         : evp_decrypt_into_with_timing(c, ciphertext.data(), ciphertextLen, out.data(), key, iv).second;
+                    });
+                    if (reference == 0.0) {
+                        reference = mean;
+                    }
+                    const double delta = (mean / reference - 1.0) * 100.0;
+                    std::cout << std::fixed << std::setprecision(2) << std::setw(12) << mean << " ("
+                              << std::showpos << std::setprecision(1) << std::setw(6) << delta << "%)"
+                              << std::noshowpos << "     ";
+                    // the description embeds the property query, which may itself hold commas
+                    csv << cipherName << "," << op << "," << csvField(entry->config.name) << ","
+                        << csvField(describeProviderConfig(entry->config)) << ","
+                        << ProviderContext::providerOf(fetched) << "," << size << "," << opts.timedIters << ","
+                        << std::fixed << std::setprecision(2) << mean << "," << stddev << ","
+                        << csvField(referenceName) << "," << std::setprecision(1) << delta << "\n";
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+    std::cout << "\nSaved provider matrix to: results/provider_results.csv" << std::endl;
+}
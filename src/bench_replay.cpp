@@ -0,0 +1,203 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace {
+// records replayed untimed before the first run, to warm caches and the cipher cache
+const size_t kWarmupRecords = 1024;
+
+// waits longer than this sleep for most of the wait and spin only for the rest
+const std::chrono::microseconds kSpinMargin(100);
+
+using Clock = std::chrono::steady_clock;
+
+// latencies and bytes of the messages of one cipher and direction (or all of them)
+struct ReplayGroup {
+    std::vector<double> latencyUs;
+    std::vector<double> serviceUs;
+    size_t bytes = 0;
+};
+
+// a trace record with its input, key and result group resolved before timing
+struct PreparedRecord {
+    const TraceRecord* record;
+    const unsigned char* input;
+    size_t inputLength;
+    const std::vector<unsigned char>* key;
+    ReplayGroup* group;
+};
+
+void runRecord(const PreparedRecord& p, unsigned char* out, const std::vector<unsigned char>& iv) {
+    if (p.record->encrypt) {
+        encrypt_into_with_timing(p.record->cipher, p.input, p.inputLength, out, *p.key, iv);
+    } else {
+        decrypt_into_with_timing(p.record->cipher, p.input, p.inputLength, out, *p.key, iv);
+    }
+}
+
+// block until `when`, sleeping for all but the last kSpinMargin
+void waitUntil(Clock::time_point when) {
+    if (when - Clock::now() > 2 * kSpinMargin) {
+        std::this_thread::sleep_until(when - kSpinMargin);
+    }
+    while (Clock::now() < when) {
+    }
+}
+}
+
+void runTraceReplay(const BenchOptions& opts) {
+    if (opts.tracePath.empty()) {
+        throw std::invalid_argument("--mode=replay needs --trace=FILE");
+    }
+    std::vector<TraceRecord> trace;
+    for (const auto& record : loadTrace(opts.tracePath)) {
+        if (std::find(opts.ciphers.begin(), opts.ciphers.end(), record.cipher) != opts.ciphers.end()) {
+            trace.push_back(record);
+        }
+    }
+    if (trace.empty()) {
+        throw std::runtime_error("Trace " + opts.tracePath + " has no messages for the selected ciphers");
+    }
+    const bool paced = opts.pacing == ReplayPacing::RECORDED;
+
+    // one random key per key id, one plaintext as long as the largest message, and for decrypt
+    // records a ciphertext per (cipher, key, size) so that padding checks pass
+    const auto iv = generateRandomBytes(16);
+    std::map<uint32_t, std::vector<unsigned char>> keys;
+    size_t maxSize = 0;
+    double traceSpanUs = 0.0;
+    for (const auto& record : trace) {
+        if (keys.find(record.keyId) == keys.end()) {
+            keys[record.keyId] = generateRandomBytes(16);
+        }
+        maxSize = std::max(maxSize, record.size);
+        traceSpanUs += record.gapUs;
+    }
+    const auto plaintext = generateRandomBytes(maxSize);
+    std::map<std::tuple<CipherType, uint32_t, size_t>, ByteBuffer> ciphertexts;
+    std::map<std::string, ReplayGroup> groups;
+    std::vector<PreparedRecord> prepared;
+    size_t totalBytes = 0;
+    for (const auto& record : trace) {
+        const auto& key = keys[record.keyId];
+        ReplayGroup* group = &groups[cipherTypeToString(record.cipher) + (record.encrypt ? " encrypt" : " decrypt")];
+        if (record.encrypt) {
+            prepared.push_back({&record, plaintext.data(), record.size, &key, group});
+        } else {
+            auto slot = std::make_tuple(record.cipher, record.keyId, record.size);
+            auto it = ciphertexts.find(slot);
+            if (it == ciphertexts.end()) {
+                ByteSpan message(plaintext.data(), record.size);
+                it = ciphertexts.emplace(slot, encrypt(record.cipher, message, key, iv)).first;
+            }
+            prepared.push_back({&record, it->second.data(), it->second.size(), &key, group});
+        }
+        totalBytes += record.size;
+    }
+    ByteBuffer out(maxSize + 16);
+
+    std::cout << "Trace " << opts.tracePath << ": " << trace.size() << " messages, " << formatBytes(totalBytes)
+              << ", " << keys.size() << " keys, recorded span " << std::fixed << std::setprecision(1)
+              << traceSpanUs / 1000.0 << " ms; pacing: " << (paced ? "recorded" : "full speed") << std::endl;
+
+    for (size_t i = 0; i < std::min(kWarmupRecords, prepared.size()); ++i) {
+        runRecord(prepared[i], out.data(), iv);
+    }
+
+    // per-run wall-clock throughput, and per-message latencies of every run; a run only writes its
+    // samples into preallocated arrays, which are sorted into the groups after the run is timed
+    std::vector<double> throughputs;
+    std::vector<double> messageRates;
+    ReplayGroup all;
+    std::map<const ReplayGroup*, size_t> groupMessages;
+    for (const auto& p : prepared) {
+        ++groupMessages[p.group];
+    }
+    for (auto& [name, group] : groups) {
+        group.latencyUs.reserve(groupMessages[&group] * opts.timedIters);
+        group.serviceUs.reserve(groupMessages[&group] * opts.timedIters);
+    }
+    all.latencyUs.reserve(prepared.size() * opts.timedIters);
+    all.serviceUs.reserve(prepared.size() * opts.timedIters);
+    std::vector<double> runServiceUs(prepared.size());
+    std::vector<double> runLatencyUs(prepared.size());
+    for (int run = 0; run < opts.timedIters; ++run) {
+        const auto start = Clock::now();
+        auto arrival = start;
+        for (size_t i = 0; i < prepared.size(); ++i) {
+            const auto& p = prepared[i];
+            // latency runs from the recorded arrival (queueing behind earlier messages included);
+            // at full speed every message arrives when the previous one finishes
+            if (paced) {
+                arrival += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double, std::micro>(p.record->gapUs));
+                waitUntil(arrival);
+            }
+            const auto t0 = Clock::now();
+            runRecord(p, out.data(), iv);
+            const auto t1 = Clock::now();
+            runServiceUs[i] = std::chrono::duration<double, std::micro>(t1 - t0).count();
+            runLatencyUs[i] = std::chrono::duration<double, std::micro>(t1 - (paced ? arrival : t0)).count();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        throughputs.push_back(static_cast<double>(totalBytes) / 1.0e6 / seconds);
+        messageRates.push_back(static_cast<double>(prepared.size()) / seconds);
+
+        for (size_t i = 0; i < prepared.size(); ++i) {
+            for (ReplayGroup* g : {prepared[i].group, &all}) {
+                g->latencyUs.push_back(runLatencyUs[i]);
+                g->serviceUs.push_back(runServiceUs[i]);
+                g->bytes += prepared[i].record->size;
+            }
+        }
+    }
+    const auto [throughput, throughputStddev] = meanAndStddev(throughputs);
+    const auto [messageRate, messageRateStddev] = meanAndStddev(messageRates);
+
+    std::cout << "Replay: " << std::setprecision(2) << throughput << " MB/s (stddev " << throughputStddev << "), "
+              << std::setprecision(0) << messageRate << " messages/s over " << opts.timedIters << " runs" << std::endl;
+    std::cout << "\n" << std::left << std::setw(18) << "Group" << std::right << std::setw(10) << "Messages"
+              << std::setw(12) << "busy MB/s" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us" << std::setw(10) << "max us" << std::endl;
+
+    auto csv = openResultsFile("replay_results.csv");
+    csv << "Trace,Pacing,Group,Messages,Bytes,Runs,Throughput(MB/s),StdDev(MB/s),Messages/s,BusyThroughput(MB/s),"
+           "p50(us),p90(us),p99(us),p99.9(us),Max(us)\n";
+    groups.emplace("all", std::move(all));
+    for (auto& [name, group] : groups) {
+        std::sort(group.latencyUs.begin(), group.latencyUs.end());
+        double busyUs = 0.0;
+        for (double us : group.serviceUs) {
+            busyUs += us;
+        }
+        // throughput while the group's messages were being processed, without idle or queueing time
+        const double busyThroughput = static_cast<double>(group.bytes) / busyUs;
+        const size_t messages = group.latencyUs.size() / opts.timedIters;
+        const auto& l = group.latencyUs;
+
+        std::cout << std::left << std::setw(18) << name << std::right << std::setw(10) << messages << std::fixed
+                  << std::setprecision(2) << std::setw(12) << busyThroughput << std::setw(10) << percentile(l, 50)
+                  << std::setw(10) << percentile(l, 90) << std::setw(10) << percentile(l, 99) << std::setw(10)
+                  << percentile(l, 99.9) << std::setw(10) << l.back() << std::endl;
+        csv << opts.tracePath << "," << (paced ? "recorded" : "full") << "," << name << "," << messages << ","
+            << group.bytes / opts.timedIters << "," << opts.timedIters << "," << std::fixed << std::setprecision(2);
+        if (name == "all") {
+            csv << throughput << "," << throughputStddev << "," << std::setprecision(0) << messageRate << ",";
+        } else {
+            csv << ",,,";
+        }
+        csv << std::setprecision(2) << busyThroughput << "," << std::setprecision(3) << percentile(l, 50) << ","
+            << percentile(l, 90) << "," << percentile(l, 99) << "," << percentile(l, 99.9) << "," << l.back() << "\n";
+    }
+    std::cout << "\nSaved replay results to: results/replay_results.csv" << std::endl;
+}
@@ -0,0 +1,160 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace {
+// a cipher reaching this fraction of memcpy bandwidth is reported as memory-bound
+const double kMemoryBoundFraction = 0.6;
+
+// every kernel touches this many bytes in total, far beyond the LLC, so all traffic goes to DRAM
+size_t dramFootprint() {
+    return 4 * lastLevelCacheSize();
+}
+
+// bandwidth in MB/s of `bytes` moved in `ms`
+double toMBps(double bytes, double ms) {
+    return (bytes / 1.0e6) / (ms / 1000.0);
+}
+
+// STREAM-style copy: memcpy between two arrays per thread; reports bytes copied (not read+written)
+double measureCopy(int threads, const BenchOptions& opts) {
+    const size_t perThread = std::max<size_t>(dramFootprint() / 2 / threads, 1 << 20);
+    const auto cpus = cpusForNode(opts.cpuNode);
+    std::vector<AlignedBuffer> src, dst;
+    for (int t = 0; t < threads; ++t) {
+        src.emplace_back(perThread, opts.layout.pageSize, opts.layout.numaNode);
+        dst.emplace_back(perThread, opts.layout.pageSize, opts.layout.numaNode);
+        std::memset(src.back().data(), t + 1, perThread);
+    }
+    auto copy = [&](int t) { std::memcpy(dst[t].data(), src[t].data(), perThread); };
+    runParallel(threads, copy, cpus);
+
+    double best = 0.0;
+    for (int i = 0; i < opts.timedIters; ++i) {
+        best = std::max(best, toMBps(static_cast<double>(perThread) * threads, runParallel(threads, copy, cpus)));
+    }
+    return best;
+}
+
+// STREAM triad a[i] = b[i] + s * c[i]; reports the STREAM convention of 3 x 8 bytes per element
+double measureTriad(int threads, const BenchOptions& opts) {
+    const size_t elems = std::max<size_t>(dramFootprint() / 3 / sizeof(double) / threads, 1 << 17);
+    const auto cpus = cpusForNode(opts.cpuNode);
+    std::vector<AlignedBuffer> a, b, c;
+    for (int t = 0; t < threads; ++t) {
+        a.emplace_back(elems * sizeof(double), opts.layout.pageSize, opts.layout.numaNode);
+        b.emplace_back(elems * sizeof(double), opts.layout.pageSize, opts.layout.numaNode);
+        c.emplace_back(elems * sizeof(double), opts.layout.pageSize, opts.layout.numaNode);
+        std::fill_n(reinterpret_cast<double*>(b.back().data()), elems, 1.0);
+        std::fill_n(reinterpret_cast<double*>(c.back().data()), elems, 2.0);
+    }
+    const double scalar = 3.0;
+    auto triad = [&](int t) {
+        double* __restrict pa = reinterpret_cast<double*>(a[t].data());
+        const double* __restrict pb = reinterpret_cast<const double*>(b[t].data());
+        const double* __restrict pc = reinterpret_cast<const double*>(c[t].data());
+        for (size_t i = 0; i < elems; ++i) {
+            pa[i] = pb[i] + scalar * pc[i];
+        }
+    };
+    runParallel(threads, triad, cpus);
+
+    double best = 0.0;
+    for (int i = 0; i < opts.timedIters; ++i) {
+        double bytes = 3.0 * sizeof(double) * elems * threads;
+        best = std::max(best, toMBps(bytes, runParallel(threads, triad, cpus)));
+    }
+    return best;
+}
+
+// best cipher throughput over DRAM-resident buffers (plaintext bytes per second, like measureCopy),
+// taken the same way as the bandwidth kernels so that fractions of copy bandwidth are not biased
+double measureCipher(CipherType cipher, bool encryptOp, int threads, const BenchOptions& opts,
+                     const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv) {
+    const size_t messageSize = opts.messageSize;
+    // decryption needs valid padding, so its inputs are the ciphertext of the message
+    auto message = generateRandomBytes(messageSize);
+    ByteBuffer input(message.begin(), message.end());
+    if (!encryptOp) {
+        input = encrypt(cipher, message, key, iv);
+    }
+    const size_t outputSize = input.size() + cipherBlockSize(cipher);
+    auto fn = encryptOp ? encrypt_into_with_timing : decrypt_into_with_timing;
+
+    std::vector<std::unique_ptr<BufferRing>> rings;
+    for (int t = 0; t < threads; ++t) {
+        rings.push_back(std::make_unique<BufferRing>(input.size(), outputSize, dramFootprint() / threads, opts.layout));
+        rings.back()->fillInputs(input.data(), input.size());
+    }
+    auto pass = [&](int t) {
+        BufferRing& ring = *rings[t];
+        for (size_t s = 0; s < ring.slots(); ++s) {
+            fn(cipher, ring.input(s), input.size(), ring.output(s), key, iv);
+        }
+    };
+    const auto cpus = cpusForNode(opts.cpuNode);
+    runParallel(threads, pass, cpus);
+
+    double best = 0.0;
+    for (int i = 0; i < opts.timedIters; ++i) {
+        double bytes = static_cast<double>(rings[0]->slots()) * messageSize * threads;
+        best = std::max(best, toMBps(bytes, runParallel(threads, pass, cpus)));
+    }
+    return best;
+}
+}
+
+void runRoofline(const BenchOptions& opts) {
+    std::vector<int> threadCounts = opts.threadCounts;
+    if (threadCounts.empty()) {
+        threadCounts = {1, availableCpus()};
+        threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    }
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+
+    auto csv = openResultsFile("roofline_results.csv");
+    csv << "Kernel,Operation,Threads,Throughput(MB/s),CopyBandwidth(MB/s),FractionOfCopy,Bound\n";
+    csv << std::fixed;
+
+    std::cout << "Footprint per kernel: " << formatBytes(dramFootprint())
+              << " (4x LLC), message size " << opts.messageSize << " B" << std::endl;
+
+    for (int threads : threadCounts) {
+        double copyBw = measureCopy(threads, opts);
+        double triadBw = measureTriad(threads, opts);
+        std::cout << "\n--- " << threads << " thread(s): memcpy " << std::fixed << std::setprecision(0)
+                  << copyBw << " MB/s, triad " << triadBw << " MB/s ---" << std::endl;
+        csv << "memcpy,copy," << threads << "," << std::setprecision(2) << copyBw << "," << copyBw << ",1.000,memory\n";
+        // triad counts all 3 x 8 bytes of traffic per element, copy only the bytes copied, so a
+        // fraction of one in the other would mean nothing; triad is listed for reference only
+        csv << "triad,triad," << threads << "," << std::setprecision(2) << triadBw << "," << copyBw << ",,\n";
+
+        std::cout << std::left << std::setw(10) << "Cipher" << std::setw(9) << "Op"
+                  << std::setw(14) << "MB/s" << std::setw(12) << "of memcpy" << "Bound" << std::right << std::endl;
+        for (CipherType cipher : opts.ciphers) {
+            for (bool encryptOp : {true, false}) {
+                double mbps = measureCipher(cipher, encryptOp, threads, opts, key, iv);
+                double fraction = mbps / copyBw;
+                const char* bound = fraction >= kMemoryBoundFraction ? "memory" : "compute";
+                const char* op = encryptOp ? "encrypt" : "decrypt";
+
+                std::cout << std::left << std::setw(10) << cipherTypeToString(cipher) << std::setw(9) << op
+                          << std::setw(14) << std::setprecision(2) << mbps
+                          << std::setw(12) << std::setprecision(1) << (fraction * 100.0) << bound
+                          << std::right << std::endl;
+                csv << cipherTypeToString(cipher) << "," << op << "," << threads << ","
+                    << std::setprecision(2) << mbps << "," << copyBw << ","
+                    << std::setprecision(3) << fraction << "," << bound << "\n";
+            }
+        }
+    }
+    std::cout << "\nSaved roofline results to: results/roofline_results.csv" << std::endl;
+}
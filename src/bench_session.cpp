@@ -0,0 +1,91 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// per-message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {64, 256, 1024, 4 * 1024, 16 * 1024};
+
+// message bytes per timed sample, so that every sample runs long enough to time reliably
+const size_t kBytesPerSample = 4 * 1024 * 1024;
+}
+
+void runSessionBenchmark(const BenchOptions& opts) {
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const auto key = generateRandomBytes(16);
+    const auto ivs = randomIvs();
+
+    auto csv = openResultsFile("session_results.csv");
+    csv << "Cipher,Operation,Variant,MessageSize(Bytes),Runs,Messages/s,ns/Message,StdDev(ns),Throughput(MB/s)\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t block = cipherBlockSize(cipher);
+        std::cout << "\n--- " << cipherName << ": full init per message vs IV-only re-init (CipherSession) ---"
+                  << std::endl;
+        std::cout << std::left << std::setw(8) << "Size" << std::setw(10) << "Op" << std::right << std::setw(16)
+                  << "full (msg/s)" << std::setw(18) << "session (msg/s)" << std::setw(12) << "speedup" << std::endl;
+
+        CipherSession encryptSession(cipher, true, key);
+        CipherSession decryptSession(cipher, false, key);
+        for (size_t size : sizes) {
+            const auto message = generateRandomBytes(size);
+            const size_t messages = std::max<size_t>(1, kBytesPerSample / size);
+            // ciphertext of the message under every IV, as input for the decrypt rows
+            std::vector<ByteBuffer> ciphertexts;
+            for (const auto& iv : ivs) {
+                ciphertexts.push_back(encrypt(cipher, message, key, iv));
+            }
+            ByteBuffer out(size + block);
+            for (size_t i = 0; i < kIvPoolSize; ++i) {
+                const size_t n = encryptSession.process(message, ivs[i].data(), out.data());
+                if (ByteSpan(out.data(), n) != ciphertexts[i]) {
+                    throw std::runtime_error("CipherSession encryption differs from encrypt() for " + cipherName);
+                }
+                const size_t m = decryptSession.process(ciphertexts[i], ivs[i].data(), out.data());
+                if (ByteSpan(out.data(), m) != ByteSpan(message)) {
+                    throw std::runtime_error("CipherSession decryption did not recover the plaintext for " + cipherName);
+                }
+            }
+
+            for (bool encryptOp : {true, false}) {
+                const std::string op = encryptOp ? "encrypt" : "decrypt";
+                auto full = nsPerMessage(opts.timedIters, messages, [&](size_t m) {
+                    const auto& iv = ivs[m % kIvPoolSize];
+                    if (encryptOp) {
+                        encrypt_into_with_timing(cipher, message.data(), size, out.data(), key, iv);
+                    } else {
+                        const auto& c = ciphertexts[m % kIvPoolSize];
+                        decrypt_into_with_timing(cipher, c.data(), c.size(), out.data(), key, iv);
+                    }
+                });
+                // the *_with_timing variant, so that both sides pay the same two clock reads per message
+                auto session = nsPerMessage(opts.timedIters, messages, [&](size_t m) {
+                    const unsigned char* iv = ivs[m % kIvPoolSize].data();
+                    if (encryptOp) {
+                        encryptSession.process_with_timing(message, iv, out.data());
+                    } else {
+                        decryptSession.process_with_timing(ciphertexts[m % kIvPoolSize], iv, out.data());
+                    }
+                });
+
+                std::cout << std::left << std::setw(8) << size << std::setw(10) << op << std::right << std::fixed
+                          << std::setprecision(0) << std::setw(16) << 1.0e9 / full.first << std::setw(18)
+                          << 1.0e9 / session.first << std::setprecision(2) << std::setw(11)
+                          << full.first / session.first << "x" << std::endl;
+                for (const auto& [variant, ns] : {std::make_pair("full init", full), std::make_pair("session", session)}) {
+                    csv << cipherName << "," << op << "," << variant << "," << size << "," << opts.timedIters << ","
+                        << std::fixed << std::setprecision(0) << 1.0e9 / ns.first << "," << std::setprecision(1)
+                        << ns.first << "," << ns.second << "," << std::setprecision(2)
+                        << (size / 1.0e6) * (1.0e9 / ns.first) << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved session results to: results/session_results.csv" << std::endl;
+}
@@ -0,0 +1,211 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+// chunk buffers in flight between the timing thread and the verifier thread
+const size_t kSlots = 4;
+
+// plaintext, ciphertext and decrypted bytes of one chunk
+struct ChunkSlot {
+    ByteBuffer plain;
+    ByteBuffer cipher;
+    ByteBuffer decrypted;
+    size_t plainLen = 0;
+    size_t decryptedLen = 0;
+};
+
+// small blocking FIFO of slot indices (closed once the producer is done)
+class SlotQueue {
+public:
+    void push(size_t slot) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_.push_back(slot);
+        }
+        cv_.notify_one();
+    }
+
+    // false once the queue is closed and drained
+    bool pop(size_t& slot) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        slot = items_.front();
+        items_.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<size_t> items_;
+    bool closed_ = false;
+};
+
+// deterministic stream contents: splitmix64 of the 8-byte word index, so any chunk can be
+// produced on its own without keeping the stream in memory
+void fillChunk(unsigned char* out, size_t length, uint64_t streamOffset) {
+    for (size_t i = 0; i < length; i += 8) {
+        uint64_t z = (streamOffset + i) / 8 + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        std::memcpy(out + i, &z, std::min<size_t>(8, length - i));
+    }
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+}
+
+void runStreamVerify(const BenchOptions& opts) {
+    const size_t streamSize = opts.streamSize;
+    const size_t chunkSize = opts.chunkSize;
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+    StreamDigest(opts.digestName); // fail early on an unknown digest name
+
+    std::cout << "Stream " << formatBytes(streamSize) << " in " << formatBytes(chunkSize)
+              << " chunks, digest " << opts.digestName << ", buffers in flight: "
+              << formatBytes(kSlots * 3 * chunkSize) << std::endl;
+
+    auto csv = openResultsFile("stream_results.csv");
+    csv << "Cipher,StreamSize(Bytes),ChunkSize(Bytes),Digest,EncryptTime(ms),EncryptThroughput(MB/s),"
+           "DecryptTime(ms),DecryptThroughput(MB/s),Verified" << kResourceCsvHeader << "\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t block = cipherBlockSize(cipher);
+        std::cout << "\n--- Streaming " << cipherName << " ---" << std::endl;
+
+        ResourceMeter meter;
+        std::vector<ChunkSlot> slots(kSlots);
+        for (auto& slot : slots) {
+            slot.plain.resize(chunkSize);
+            slot.cipher.resize(chunkSize + block);
+            slot.decrypted.resize(chunkSize + 2 * block);
+        }
+        SlotQueue freeSlots, fullSlots;
+        for (size_t s = 0; s < kSlots; ++s) {
+            freeSlots.push(s);
+        }
+
+        // verifier thread: digests original and decrypted bytes, off the timing thread
+        StreamDigest originalDigest(opts.digestName), decryptedDigest(opts.digestName);
+        std::exception_ptr verifierError;
+        std::thread verifier([&] {
+            try {
+                size_t s = 0;
+                while (fullSlots.pop(s)) {
+                    originalDigest.update({slots[s].plain.data(), slots[s].plainLen});
+                    decryptedDigest.update({slots[s].decrypted.data(), slots[s].decryptedLen});
+                    freeSlots.push(s);
+                }
+            } catch (...) {
+                verifierError = std::current_exception();
+                freeSlots.close(); // wake the producer, which would otherwise wait for a slot forever
+            }
+        });
+        // the next free slot; throws once the verifier has stopped returning them
+        auto takeFreeSlot = [&] {
+            size_t s = 0;
+            if (!freeSlots.pop(s)) {
+                throw std::runtime_error("Streaming verifier thread stopped");
+            }
+            return s;
+        };
+
+        double encMs = 0.0, decMs = 0.0;
+        try {
+            CipherStream encryptor(cipher, true, key, iv);
+            CipherStream decryptor(cipher, false, key, iv);
+            for (uint64_t offset = 0; offset < streamSize; offset += chunkSize) {
+                const size_t s = takeFreeSlot();
+                ChunkSlot& slot = slots[s];
+                slot.plainLen = static_cast<size_t>(std::min<uint64_t>(chunkSize, streamSize - offset));
+                fillChunk(slot.plain.data(), slot.plainLen, offset);
+
+                auto t0 = std::chrono::steady_clock::now();
+                size_t ctLen = encryptor.update({slot.plain.data(), slot.plainLen}, slot.cipher.data());
+                encMs += elapsedMs(t0);
+                t0 = std::chrono::steady_clock::now();
+                slot.decryptedLen = decryptor.update({slot.cipher.data(), ctLen}, slot.decrypted.data());
+                decMs += elapsedMs(t0);
+                fullSlots.push(s);
+            }
+
+            // padding block: encrypt's tail goes through the decryptor, then both finish
+            const size_t s = takeFreeSlot();
+            ChunkSlot& slot = slots[s];
+            auto t0 = std::chrono::steady_clock::now();
+            size_t tailLen = encryptor.finish(slot.cipher.data());
+            encMs += elapsedMs(t0);
+            t0 = std::chrono::steady_clock::now();
+            slot.decryptedLen = decryptor.update({slot.cipher.data(), tailLen}, slot.decrypted.data());
+            slot.decryptedLen += decryptor.finish(slot.decrypted.data() + slot.decryptedLen);
+            decMs += elapsedMs(t0);
+            slot.plainLen = 0;
+            fullSlots.push(s);
+        } catch (...) {
+            fullSlots.close();
+            verifier.join();
+            if (verifierError) {
+                std::rethrow_exception(verifierError); // the cause, rather than the stopped verifier
+            }
+            throw;
+        }
+        fullSlots.close();
+        verifier.join();
+        if (verifierError) {
+            std::rethrow_exception(verifierError);
+        }
+
+        auto expected = originalDigest.finish();
+        auto actual = decryptedDigest.finish();
+        const bool verified = expected == actual;
+        CellResources resources = meter.finish();
+        double encMBps = (streamSize / 1.0e6) / (encMs / 1000.0);
+        double decMBps = (streamSize / 1.0e6) / (decMs / 1000.0);
+        std::cout << "Encrypt: " << std::fixed << std::setprecision(3) << encMs << " ms, "
+                  << std::setprecision(2) << encMBps << " MB/s" << std::endl;
+        std::cout << "Decrypt: " << std::setprecision(3) << decMs << " ms, "
+                  << std::setprecision(2) << decMBps << " MB/s" << std::endl;
+        std::cout << "Digest original:  " << toHex(expected) << "\n"
+                  << "Digest decrypted: " << toHex(actual) << std::endl;
+        std::cout << "Memory: " << formatResources(resources) << std::endl;
+        csv << cipherName << "," << streamSize << "," << chunkSize << "," << opts.digestName << ","
+            << std::setprecision(3) << encMs << "," << std::setprecision(2) << encMBps << ","
+            << std::setprecision(3) << decMs << "," << std::setprecision(2) << decMBps << ","
+            << (verified ? "yes" : "no");
+        writeResourceCsv(csv, resources);
+        csv << "\n";
+        if (!verified) {
+            throw std::runtime_error("Streaming verification failed: digest mismatch with cipher " + cipherName);
+        }
+    }
+    std::cout << "\nSaved streaming results to: results/stream_results.csv" << std::endl;
+}
@@ -0,0 +1,138 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "key_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+// distinct key counts swept when --keys is not given
+const std::vector<int> kDefaultKeyCounts = {1, 16, 256, 1024, 4096, 16384, 65536};
+
+// per-message sizes compared when --sizes is not given
+const std::vector<size_t> kDefaultSizes = {64, 1024};
+
+// message bytes per timed sample, and the fewest messages a sample may have
+const size_t kBytesPerSample = 4 * 1024 * 1024;
+const size_t kMinMessagesPerSample = 16 * 1024;
+
+// fixed seed, so that every variant and every run sees the same key sequence
+const uint64_t kScheduleSeed = 0x5eed;
+
+// draws key ids 0..n-1 with P(k) proportional to 1 / (k + 1)^s (s = 0: uniform)
+class ZipfSampler {
+public:
+    ZipfSampler(size_t n, double s) : cdf_(n) {
+        double sum = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            cdf_[k] = sum;
+        }
+        for (double& c : cdf_) {
+            c /= sum;
+        }
+    }
+
+    uint32_t operator()(std::mt19937_64& rng) const {
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        return static_cast<uint32_t>(std::min<size_t>(it - cdf_.begin(), cdf_.size() - 1));
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+}
+
+void runTenantWorkload(const BenchOptions& opts) {
+    const std::vector<int> keyCounts = opts.keyCounts.empty() ? kDefaultKeyCounts : opts.keyCounts;
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const int maxKeys = *std::max_element(keyCounts.begin(), keyCounts.end());
+    const auto keyPool = generateRandomBytes(static_cast<size_t>(maxKeys) * 16);
+    std::vector<std::vector<unsigned char>> keys;
+    for (int k = 0; k < maxKeys; ++k) {
+        keys.emplace_back(keyPool.begin() + k * 16, keyPool.begin() + (k + 1) * 16);
+    }
+    const auto ivs = randomIvs();
+
+    std::cout << "Key popularity: Zipf s=" << opts.zipfExponent << ", key cache capacity: " << opts.keyCacheSize
+              << " contexts" << std::endl;
+    auto csv = openResultsFile("tenant_results.csv");
+    csv << "Cipher,Keys,ZipfExponent,CacheCapacity,MessageSize(Bytes),Variant,Runs,Messages/s,ns/Message,StdDev(ns),"
+           "Throughput(MB/s),HitRate(%),Evictions/Message\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t block = cipherBlockSize(cipher);
+        std::cout << "\n--- " << cipherName << ": full init per message vs KeyedContextCache (encrypt) ---" << std::endl;
+        std::cout << std::left << std::setw(8) << "Keys" << std::setw(8) << "Size" << std::right << std::setw(16)
+                  << "full (msg/s)" << std::setw(16) << "cache (msg/s)" << std::setw(10) << "speedup" << std::setw(12)
+                  << "hit rate" << std::endl;
+
+        for (size_t size : sizes) {
+            const auto message = generateRandomBytes(size);
+            const size_t messages = std::max(kMinMessagesPerSample, kBytesPerSample / size);
+            ByteBuffer out(size + block);
+
+            for (int keyCount : keyCounts) {
+                // one key sequence per cell, shared by both variants and every sample
+                std::mt19937_64 rng(kScheduleSeed);
+                const ZipfSampler sampler(static_cast<size_t>(keyCount), opts.zipfExponent);
+                std::vector<uint32_t> schedule(messages);
+                for (auto& id : schedule) {
+                    id = sampler(rng);
+                }
+
+                KeyedContextCache cache(cipher, true, static_cast<size_t>(opts.keyCacheSize));
+                for (size_t m = 0; m < std::min<size_t>(messages, 16); ++m) {
+                    const auto& key = keys[schedule[m]];
+                    const auto& iv = ivs[m % kIvPoolSize];
+                    const size_t n = cache.process(schedule[m], key, message, iv.data(), out.data());
+                    if (ByteSpan(out.data(), n) != encrypt(cipher, message, key, iv)) {
+                        throw std::runtime_error("KeyedContextCache encryption differs from encrypt() for " + cipherName);
+                    }
+                }
+
+                auto full = nsPerMessage(opts.timedIters, messages, [&](size_t m) {
+                    encrypt_into_with_timing(cipher, message.data(), size, out.data(), keys[schedule[m]],
+                                             ivs[m % kIvPoolSize]);
+                });
+                // the warm-up pass fills the cache and its counters are dropped, so the hit rate is
+                // the steady-state one; both sides read the clock around every message alike
+                auto cached = nsPerMessage(opts.timedIters, messages, [&](size_t m) {
+                    cache.process_with_timing(schedule[m], keys[schedule[m]], message, ivs[m % kIvPoolSize].data(),
+                                              out.data());
+                }, [&] { cache.resetStats(); });
+                const double lookups = static_cast<double>(cache.hits() + cache.misses());
+                const double hitRate = 100.0 * static_cast<double>(cache.hits()) / lookups;
+                const double evictionsPerMessage = static_cast<double>(cache.evictions()) / lookups;
+
+                std::cout << std::left << std::setw(8) << keyCount << std::setw(8) << size << std::right << std::fixed
+                          << std::setprecision(0) << std::setw(16) << 1.0e9 / full.first << std::setw(16)
+                          << 1.0e9 / cached.first << std::setprecision(2) << std::setw(9)
+                          << full.first / cached.first << "x" << std::setprecision(1) << std::setw(11) << hitRate
+                          << "%" << std::endl;
+                for (bool isCache : {false, true}) {
+                    const auto& ns = isCache ? cached : full;
+                    csv << cipherName << "," << keyCount << "," << std::defaultfloat << opts.zipfExponent << ","
+                        << opts.keyCacheSize << "," << size << "," << (isCache ? "key cache" : "full init") << ","
+                        << opts.timedIters << "," << std::fixed << std::setprecision(0) << 1.0e9 / ns.first << ","
+                        << std::setprecision(1) << ns.first << "," << ns.second << "," << std::setprecision(2)
+                        << (size / 1.0e6) * (1.0e9 / ns.first) << ",";
+                    if (isCache) {
+                        csv << std::setprecision(1) << hitRate << "," << std::setprecision(4) << evictionsPerMessage;
+                    } else {
+                        csv << ",";
+                    }
+                    csv << "\n";
+                }
+            }
+        }
+    }
+    std::cout << "\nSaved tenant results to: results/tenant_results.csv" << std::endl;
+}
@@ -0,0 +1,117 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+#include "mem_utils.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace {
+// bytes each thread encrypts per timed sample, so that small working sets are swept many times
+const size_t kBytesPerThreadSample = 16 * 1024 * 1024;
+
+// A working set fits a cache level if each thread's share fits in the part of one cache
+// instance it gets (private caches are not split, shared ones are split among the threads).
+std::string tierFor(size_t workingSet, int threads, const std::vector<CacheLevel>& levels) {
+    const size_t perThread = workingSet / threads;
+    for (const auto& cache : levels) {
+        const size_t sharers = static_cast<size_t>(std::max(1, std::min(cache.sharedCpus, threads)));
+        if (perThread <= cache.sizeBytes / sharers) {
+            return "L" + std::to_string(cache.level);
+        }
+    }
+    return "DRAM";
+}
+
+// half and twice every cache size, plus 4x the LLC, so each boundary is crossed once
+std::vector<size_t> sweepSizes(const std::vector<CacheLevel>& levels, size_t minSize) {
+    std::vector<size_t> sizes;
+    for (const auto& cache : levels) {
+        sizes.push_back(cache.sizeBytes / 2);
+        sizes.push_back(cache.sizeBytes * 2);
+    }
+    sizes.push_back(lastLevelCacheSize() * 4);
+    for (auto& s : sizes) {
+        s = std::max(s, minSize);
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    return sizes;
+}
+}
+
+void runWorkingSetSweep(const BenchOptions& opts) {
+    auto levels = detectCacheHierarchy();
+    std::cout << "Detected caches:";
+    if (levels.empty()) {
+        std::cout << " none (using " << formatBytes(lastLevelCacheSize()) << " LLC fallback)";
+    }
+    for (const auto& cache : levels) {
+        std::cout << " L" << cache.level << "=" << formatBytes(cache.sizeBytes)
+                  << " (shared by " << cache.sharedCpus << " CPUs)";
+    }
+    std::cout << std::endl;
+
+    const size_t messageSize = opts.messageSize;
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+    const auto message = generateRandomBytes(messageSize);
+    const auto threadCounts = defaultThreadCounts(opts.threadCounts);
+    const auto sizes = sweepSizes(levels, 2 * messageSize);
+    const auto cpus = cpusForNode(opts.cpuNode);
+
+    auto csv = openResultsFile("wss_results.csv");
+    csv << "Cipher,Threads,WorkingSet(Bytes),Tier,MessageSize(Bytes),Runs,Throughput(MB/s),StdDev(MB/s)" << kResourceCsvHeader << "\n";
+
+    for (CipherType cipher : opts.ciphers) {
+        const std::string cipherName = cipherTypeToString(cipher);
+        const size_t outputSize = messageSize + cipherBlockSize(cipher);
+        std::cout << "\n--- Working-set sweep: " << cipherName << ", " << messageSize << " B messages ---" << std::endl;
+        std::cout << std::left << std::setw(9) << "Threads" << std::setw(12) << "WorkingSet"
+                  << std::setw(7) << "Tier" << "Throughput (MB/s)" << std::right << std::endl;
+
+        for (int threads : threadCounts) {
+            for (size_t workingSet : sizes) {
+                ResourceMeter meter; // covers buffer setup too: that is the cell's memory cost
+                // one ring per thread, each covering its share of the working set
+                std::vector<std::unique_ptr<BufferRing>> rings;
+                for (int t = 0; t < threads; ++t) {
+                    rings.push_back(std::make_unique<BufferRing>(messageSize, outputSize, workingSet / threads, opts.layout));
+                    rings.back()->fillInputs(message.data(), message.size());
+                }
+                const size_t messagesPerThread =
+                    std::max(rings[0]->slots(), kBytesPerThreadSample / messageSize);
+
+                auto sweep = [&](int t) {
+                    BufferRing& ring = *rings[t];
+                    for (size_t m = 0; m < messagesPerThread; ++m) {
+                        encrypt_into_with_timing(cipher, ring.input(m), messageSize, ring.output(m), key, iv);
+                    }
+                };
+                runParallel(threads, sweep, cpus); // warm-up: brings the working set into its tier
+
+                std::vector<double> throughputs;
+                for (int i = 0; i < opts.timedIters; ++i) {
+                    double ms = runParallel(threads, sweep, cpus);
+                    double bytes = static_cast<double>(messagesPerThread) * messageSize * threads;
+                    throughputs.push_back((bytes / 1.0e6) / (ms / 1000.0));
+                }
+                auto [mean, stddev] = meanAndStddev(throughputs);
+                CellResources resources = meter.finish();
+                const std::string tier = tierFor(workingSet, threads, levels);
+
+                std::cout << std::left << std::setw(9) << threads << std::setw(12) << formatBytes(workingSet)
+                          << std::setw(7) << tier << std::right << std::fixed << std::setprecision(2)
+                          << mean << " +/- " << stddev << "   " << formatResources(resources) << std::endl;
+                csv << cipherName << "," << threads << "," << workingSet << "," << tier << ","
+                    << messageSize << "," << opts.timedIters << ","
+                    << std::fixed << std::setprecision(2) << mean << "," << stddev;
+                writeResourceCsv(csv, resources);
+                csv << "\n";
+            }
+        }
+    }
+    std::cout << "\nSaved working-set sweep results to: results/wss_results.csv" << std::endl;
+}
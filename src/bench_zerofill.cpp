@@ -0,0 +1,94 @@
+#include "bench_modes.hpp"
+#include "bench_common.hpp"
+#include "crypto_utils.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+// output sizes compared when --sizes is not given: one that fits in L3 and two that go to DRAM
+const std::vector<size_t> kDefaultSizes = {
+    size_t{5} << 19, // 2.5 MiB
+    size_t{64} << 20,
+    size_t{1} << 30,
+};
+
+// read back one byte so the compiler cannot drop an allocation it can see is unused
+volatile unsigned char sink;
+
+double elapsedMs(std::chrono::steady_clock::time_point t0, std::chrono::steady_clock::time_point t1) {
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// allocate an output buffer of type Buffer and encrypt `input` into it; returns wall ms of
+// allocation plus encryption (the buffer is freed outside the timed region)
+template <typename Buffer>
+double allocateAndEncrypt(CipherType cipher, ByteSpan input, const std::vector<unsigned char>& key,
+                          const std::vector<unsigned char>& iv) {
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    Buffer out(input.size() + cipherBlockSize(cipher));
+    encrypt_into_with_timing(cipher, input.data(), input.size(), out.data(), key, iv);
+    auto t1 = clock::now();
+    sink = out[out.size() / 2];
+    return elapsedMs(t0, t1);
+}
+}
+
+void runZeroFillCost(const BenchOptions& opts) {
+    using clock = std::chrono::steady_clock;
+    const std::vector<size_t> sizes = opts.datasetSizes.empty() ? kDefaultSizes : opts.datasetSizes;
+    const int iters = opts.timedIters;
+    const auto key = generateRandomBytes(16);
+    const auto iv = generateRandomBytes(16);
+
+    auto csv = openResultsFile("zerofill_results.csv");
+    csv << "Cipher,Size(Bytes),Iterations,ZeroFillMs,ZeroFillGBs,ValueInitMs,DefaultInitMs,SavedMs,SavedPercent\n";
+
+    for (size_t size : sizes) {
+        const auto input = generateRandomBytes(size);
+
+        // the pass value-initialisation adds: allocating and zeroing a fresh std::vector
+        std::vector<double> fillTimes;
+        for (int i = 0; i < iters; ++i) {
+            auto t0 = clock::now();
+            std::vector<unsigned char> zeroed(size);
+            auto t1 = clock::now();
+            sink = zeroed[size / 2];
+            fillTimes.push_back(elapsedMs(t0, t1));
+        }
+        const double fillMs = meanAndStddev(fillTimes).first;
+        const double fillGBs = (size / 1.0e9) / (fillMs / 1000.0);
+
+        std::cout << "\n--- Output value-initialisation cost, " << formatBytes(size) << " ---" << std::endl;
+        std::cout << "zero-fill of a fresh std::vector: " << std::fixed << std::setprecision(3) << fillMs
+                  << " ms (" << std::setprecision(2) << fillGBs << " GB/s incl. page faults)" << std::endl;
+        std::cout << std::left << std::setw(10) << "Cipher" << std::setw(18) << "value-init ms"
+                  << std::setw(18) << "default-init ms" << "saved" << std::right << std::endl;
+
+        for (CipherType cipher : opts.ciphers) {
+            const std::string cipherName = cipherTypeToString(cipher);
+            // alternate the variants so drift in clock speed or memory state hits both alike
+            std::vector<double> valueTimes;
+            std::vector<double> defaultTimes;
+            for (int i = 0; i < iters; ++i) {
+                valueTimes.push_back(allocateAndEncrypt<std::vector<unsigned char>>(cipher, input, key, iv));
+                defaultTimes.push_back(allocateAndEncrypt<ByteBuffer>(cipher, input, key, iv));
+            }
+            const double valueMs = meanAndStddev(valueTimes).first;
+            const double defaultMs = meanAndStddev(defaultTimes).first;
+            const double savedMs = valueMs - defaultMs;
+            const double savedPct = 100.0 * savedMs / valueMs;
+
+            std::cout << std::left << std::setw(10) << cipherName << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(14) << valueMs << "    "
+                      << std::setw(14) << defaultMs << "    " << savedMs << " ms ("
+                      << std::setprecision(1) << savedPct << "%)" << std::endl;
+            csv << cipherName << "," << size << "," << iters << "," << std::setprecision(6) << fillMs << ","
+                << std::setprecision(3) << fillGBs << "," << std::setprecision(6) << valueMs << ","
+                << defaultMs << "," << savedMs << "," << std::setprecision(2) << savedPct << "\n";
+        }
+    }
+    std::cout << "\nSaved value-initialisation results to: results/zerofill_results.csv" << std::endl;
+}
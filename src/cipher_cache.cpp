@@ -0,0 +1,105 @@
+#include "cipher_cache.hpp"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+// the fetched ciphers, freed by the destructor at exit
+class CipherCache {
+public:
+    // initialising OpenSSL first registers its own exit handler before ours, so it runs after
+    // the destructor has freed the ciphers
+    CipherCache() { OPENSSL_init_crypto(0, nullptr); }
+    ~CipherCache() { clear(); }
+
+    const EVP_CIPHER* get(const std::string& name, const std::string& properties) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto key = std::make_pair(name, properties);
+        auto it = ciphers_.find(key);
+        if (it != ciphers_.end()) {
+            return it->second;
+        }
+        EVP_CIPHER* cipher = EVP_CIPHER_fetch(nullptr, name.c_str(), properties.empty() ? nullptr : properties.c_str());
+        if (!cipher) {
+            throw std::runtime_error("EVP_CIPHER_fetch failed for " + name
+                                     + (properties.empty() ? "" : " (" + properties + ")"));
+        }
+        ciphers_.emplace(std::move(key), cipher);
+        return cipher;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ciphers_.size();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : ciphers_) {
+            EVP_CIPHER_free(entry.second);
+        }
+        ciphers_.clear();
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+private:
+    std::mutex mutex_;
+    std::map<std::pair<std::string, std::string>, EVP_CIPHER*> ciphers_;
+    std::atomic<uint64_t> generation_{0};
+};
+
+CipherCache& cache() {
+    static CipherCache instance;
+    return instance;
+}
+}
+
+std::string evpCipherName(CipherType cipher) {
+    switch (cipher) {
+        case CipherType::AES:
+            return "AES-128-CBC";
+        case CipherType::CAMELLIA:
+            return "CAMELLIA-128-CBC";
+        case CipherType::SM4:
+            return "SM4-CBC";
+        default:
+            throw std::runtime_error("Unsupported cipher type");
+    }
+}
+
+const evp_cipher_st* legacyCipher(CipherType cipher) {
+    switch (cipher) {
+        case CipherType::AES:
+            return EVP_aes_128_cbc();
+        case CipherType::CAMELLIA:
+            return EVP_camellia_128_cbc();
+        case CipherType::SM4:
+            return EVP_sm4_cbc();
+        default:
+            throw std::runtime_error("Unsupported cipher type");
+    }
+}
+
+const evp_cipher_st* fetchCipher(const std::string& name, const std::string& properties) {
+    return cache().get(name, properties);
+}
+
+size_t cipherCacheSize() {
+    return cache().size();
+}
+
+void clearCipherCache() {
+    cache().clear();
+}
+
+uint64_t cipherCacheGeneration() {
+    return cache().generation();
+}
@@ -0,0 +1,577 @@
+// the low-level AES/Camellia calls are deprecated in OpenSSL 3 but are exactly what this backend measures
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include "crypto_backend.hpp"
+#include "aes_kernels.hpp"
+
+#include <openssl/evp.h>
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+#include <openssl/aes.h>
+#include <openssl/camellia.h>
+#define BENCH_HAVE_LOWLEVEL 1
+#endif
+
+#include <fcntl.h>
+#include <linux/if_alg.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#ifndef SOL_ALG
+#define SOL_ALG 279
+#endif
+
+std::string backendTypeToString(BackendType backend) {
+    switch (backend) {
+        case BackendType::EVP:
+            return "evp";
+        case BackendType::EVP_CIPHER:
+            return "evp-cipher";
+        case BackendType::LOWLEVEL:
+            return "lowlevel";
+        case BackendType::INTREE:
+            return "intree";
+        case BackendType::AFALG:
+            return "afalg";
+        default:
+            return "unknown";
+    }
+}
+
+BackendType backendTypeFromString(const std::string& name) {
+    std::string lower;
+    for (char c : name) {
+        lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    for (BackendType backend : allBackendTypes()) {
+        if (backendTypeToString(backend) == lower) {
+            return backend;
+        }
+    }
+    throw std::invalid_argument("Unknown backend: " + name);
+}
+
+std::vector<BackendType> allBackendTypes() {
+    return {BackendType::EVP, BackendType::EVP_CIPHER, BackendType::LOWLEVEL, BackendType::INTREE,
+            BackendType::AFALG};
+}
+
+namespace {
+using clock = std::chrono::steady_clock;
+
+double elapsedMs(clock::time_point t0, clock::time_point t1) {
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// last plaintext block: the tail of the message followed by PKCS#7 padding; returns its length
+size_t padLastBlock(const unsigned char* tail, size_t tailLength, size_t block, unsigned char* last) {
+    std::memcpy(last, tail, tailLength);
+    std::memset(last + tailLength, static_cast<int>(block - tailLength), block - tailLength);
+    return block;
+}
+
+// length of the plaintext once the PKCS#7 padding of a decrypted buffer is removed
+size_t unpaddedLength(const unsigned char* plain, size_t length, size_t block) {
+    const unsigned char pad = length ? plain[length - 1] : 0;
+    bool valid = pad >= 1 && pad <= block;
+    for (size_t i = 0; valid && i < pad; ++i) {
+        valid = plain[length - 1 - i] == pad;
+    }
+    if (!valid) {
+        throw std::runtime_error("CBC decryption failed: bad padding");
+    }
+    return length - pad;
+}
+
+void requireWholeBlocks(size_t length, size_t block) {
+    if (length == 0 || length % block != 0) {
+        throw std::runtime_error("CBC decryption failed: ciphertext is not a whole number of blocks");
+    }
+}
+
+class EvpBackend : public CryptoBackend {
+public:
+    BackendType type() const override { return BackendType::EVP; }
+    bool supports(CipherType) const override { return true; }
+
+    std::pair<size_t, double> encryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        return encrypt_into_with_timing(cipher, in, length, out, key, iv);
+    }
+
+    std::pair<size_t, double> decryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        return decrypt_into_with_timing(cipher, in, length, out, key, iv);
+    }
+};
+
+// EVP_Cipher() is the thinnest EVP entry point: no partial-block buffering and no padding, so the
+// context is re-initialised per call with padding off and the padding is handled here
+class EvpCipherBackend : public CryptoBackend {
+public:
+    EvpCipherBackend() : ctx_(EVP_CIPHER_CTX_new()) {
+        if (!ctx_) {
+            throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+        }
+    }
+    ~EvpCipherBackend() override { EVP_CIPHER_CTX_free(ctx_); }
+    EvpCipherBackend(const EvpCipherBackend&) = delete;
+    EvpCipherBackend& operator=(const EvpCipherBackend&) = delete;
+
+    BackendType type() const override { return BackendType::EVP_CIPHER; }
+    bool supports(CipherType) const override { return true; }
+
+    std::pair<size_t, double> encryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        const size_t block = cipherBlockSize(cipher);
+        const size_t full = length / block * block;
+        auto t0 = clock::now();
+        init(cipher, true, key, iv);
+        if (full > 0) {
+            run(out, in, full);
+        }
+        unsigned char last[EVP_MAX_BLOCK_LENGTH];
+        run(out + full, last, padLastBlock(in + full, length - full, block, last));
+        auto t1 = clock::now();
+        return {full + block, elapsedMs(t0, t1)};
+    }
+
+    std::pair<size_t, double> decryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        const size_t block = cipherBlockSize(cipher);
+        requireWholeBlocks(length, block);
+        auto t0 = clock::now();
+        init(cipher, false, key, iv);
+        run(out, in, length);
+        const size_t plainLength = unpaddedLength(out, length, block);
+        auto t1 = clock::now();
+        return {plainLength, elapsedMs(t0, t1)};
+    }
+
+private:
+    void init(CipherType cipher, bool encrypt, const std::vector<unsigned char>& key,
+              const std::vector<unsigned char>& iv) {
+        if (EVP_CipherInit_ex(ctx_, evpCipher(cipher), nullptr, key.data(), iv.data(), encrypt ? 1 : 0) != 1
+            || EVP_CIPHER_CTX_set_padding(ctx_, 0) != 1) {
+            throw std::runtime_error("EVP_CipherInit_ex failed");
+        }
+    }
+
+    void run(unsigned char* out, const unsigned char* in, size_t length) {
+        if (EVP_Cipher(ctx_, out, in, static_cast<unsigned int>(length)) <= 0) {
+            throw std::runtime_error("EVP_Cipher failed");
+        }
+    }
+
+    EVP_CIPHER_CTX* ctx_;
+};
+
+// the pre-EVP per-algorithm API: key schedule and CBC loop called directly, padding done here
+class LowLevelBackend : public CryptoBackend {
+public:
+    BackendType type() const override { return BackendType::LOWLEVEL; }
+
+    bool supports(CipherType cipher) const override {
+#ifdef BENCH_HAVE_LOWLEVEL
+        return cipher == CipherType::AES || cipher == CipherType::CAMELLIA;
+#else
+        (void)cipher;
+        return false;
+#endif
+    }
+
+    std::pair<size_t, double> encryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        const size_t block = cipherBlockSize(cipher);
+        const size_t full = length / block * block;
+        unsigned char last[EVP_MAX_BLOCK_LENGTH];
+        auto t0 = clock::now();
+        padLastBlock(in + full, length - full, block, last);
+        crypt(cipher, true, in, full, last, out, key, iv);
+        auto t1 = clock::now();
+        return {full + block, elapsedMs(t0, t1)};
+    }
+
+    std::pair<size_t, double> decryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        const size_t block = cipherBlockSize(cipher);
+        requireWholeBlocks(length, block);
+        auto t0 = clock::now();
+        crypt(cipher, false, in, length, nullptr, out, key, iv);
+        const size_t plainLength = unpaddedLength(out, length, block);
+        auto t1 = clock::now();
+        return {plainLength, elapsedMs(t0, t1)};
+    }
+
+private:
+    // CBC over `length` bytes of `in`, then (when encrypting) the padded `last` block; the IV copy
+    // is chained across both calls because the low-level functions update it in place
+    void crypt(CipherType cipher, bool encrypt, const unsigned char* in, size_t length,
+               const unsigned char* last, unsigned char* out, const std::vector<unsigned char>& key,
+               const std::vector<unsigned char>& iv) {
+#ifdef BENCH_HAVE_LOWLEVEL
+        unsigned char ivec[16];
+        std::memcpy(ivec, iv.data(), sizeof(ivec));
+        const int enc = encrypt ? AES_ENCRYPT : AES_DECRYPT;
+        if (cipher == CipherType::AES) {
+            AES_KEY schedule;
+            const int rc = encrypt ? AES_set_encrypt_key(key.data(), 128, &schedule)
+                                   : AES_set_decrypt_key(key.data(), 128, &schedule);
+            if (rc != 0) {
+                throw std::runtime_error("AES_set_key failed");
+            }
+            AES_cbc_encrypt(in, out, length, &schedule, ivec, enc);
+            if (last) {
+                AES_cbc_encrypt(last, out + length, 16, &schedule, ivec, enc);
+            }
+        } else if (cipher == CipherType::CAMELLIA) {
+            CAMELLIA_KEY schedule;
+            if (Camellia_set_key(key.data(), 128, &schedule) != 0) {
+                throw std::runtime_error("Camellia_set_key failed");
+            }
+            Camellia_cbc_encrypt(in, out, length, &schedule, ivec, enc);
+            if (last) {
+                Camellia_cbc_encrypt(last, out + length, 16, &schedule, ivec, enc);
+            }
+        } else {
+            throw std::runtime_error("lowlevel backend has no " + cipherTypeToString(cipher) + " API");
+        }
+#else
+        (void)encrypt; (void)in; (void)length; (void)last; (void)out; (void)key; (void)iv;
+        throw std::runtime_error("lowlevel backend has no " + cipherTypeToString(cipher) + " API in this OpenSSL build");
+#endif
+    }
+};
+
+// AES-128-CBC on the fastest in-tree kernel the CPU supports
+class InTreeBackend : public CryptoBackend {
+public:
+    InTreeBackend() : isa_(aesIsaAvailable(AesIsa::VAES) ? AesIsa::VAES : AesIsa::AESNI) {}
+
+    BackendType type() const override { return BackendType::INTREE; }
+
+    bool supports(CipherType cipher) const override {
+        return cipher == CipherType::AES && aesIsaAvailable(isa_);
+    }
+
+    std::pair<size_t, double> encryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        requireAes(cipher);
+        return aes_kernel_encrypt_into_with_timing(isa_, AesMode::CBC, in, length, out, key, iv);
+    }
+
+    std::pair<size_t, double> decryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        requireAes(cipher);
+        return aes_kernel_decrypt_into_with_timing(isa_, AesMode::CBC, in, length, out, key, iv);
+    }
+
+private:
+    static void requireAes(CipherType cipher) {
+        if (cipher != CipherType::AES) {
+            throw std::runtime_error("intree backend has no " + cipherTypeToString(cipher) + " kernel");
+        }
+    }
+
+    AesIsa isa_;
+};
+
+// owns a file descriptor, closed on destruction
+class Fd {
+public:
+    explicit Fd(int fd = -1) : fd_(fd) {}
+    ~Fd() { reset(); }
+    Fd(Fd&& other) noexcept : fd_(other.fd_) { other.fd_ = -1; }
+    Fd& operator=(Fd&& other) noexcept {
+        if (this != &other) {
+            reset();
+            fd_ = other.fd_;
+            other.fd_ = -1;
+        }
+        return *this;
+    }
+    Fd(const Fd&) = delete;
+    Fd& operator=(const Fd&) = delete;
+
+    int get() const { return fd_; }
+    void reset() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+private:
+    int fd_;
+};
+
+std::runtime_error sysError(const std::string& what) {
+    return std::runtime_error("AF_ALG " + what + " failed: " + std::strerror(errno));
+}
+
+// Kernel skcipher through AF_ALG. One socket per cipher is bound to the algorithm ("cbc(aes)")
+// once, like fetching an EVP cipher; every call sets the key on it, accepts an operation socket,
+// sends the operation and IV as control data with the input, reads the output and closes the
+// operation socket. Small messages go out in a single sendmsg; larger ones are fed in chunks
+// through vmsplice/splice from a pipe so the kernel reads the caller's pages without a copy.
+// The kernel's cbc() does no padding, so PKCS#7 is handled here as for the other backends.
+class AfAlgBackend : public CryptoBackend {
+public:
+    BackendType type() const override { return BackendType::AFALG; }
+
+    bool supports(CipherType cipher) const override {
+        return boundSocket(cipher) >= 0;
+    }
+
+    uint64_t syscalls() const override { return syscalls_; }
+
+    std::pair<size_t, double> encryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        const size_t block = cipherBlockSize(cipher);
+        const size_t full = length / block * block;
+        unsigned char last[EVP_MAX_BLOCK_LENGTH];
+        auto t0 = clock::now();
+        padLastBlock(in + full, length - full, block, last);
+        crypt(cipher, true, in, full, last, block, out, key, iv);
+        auto t1 = clock::now();
+        return {full + block, elapsedMs(t0, t1)};
+    }
+
+    std::pair<size_t, double> decryptInto(CipherType cipher, const unsigned char* in, size_t length,
+                                          unsigned char* out, const std::vector<unsigned char>& key,
+                                          const std::vector<unsigned char>& iv) override {
+        const size_t block = cipherBlockSize(cipher);
+        requireWholeBlocks(length, block);
+        auto t0 = clock::now();
+        crypt(cipher, false, in, length, nullptr, 0, out, key, iv);
+        const size_t plainLength = unpaddedLength(out, length, block);
+        auto t1 = clock::now();
+        return {plainLength, elapsedMs(t0, t1)};
+    }
+
+private:
+    // below this many bytes the input is copied in with the control message (one sendmsg)
+    static constexpr size_t kSpliceThreshold = 16 * 1024;
+    // bytes fed to the kernel before reading output back; the default pipe holds 16 pages
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    static const char* kernelName(CipherType cipher) {
+        switch (cipher) {
+            case CipherType::AES:
+                return "cbc(aes)";
+            case CipherType::CAMELLIA:
+                return "cbc(camellia)";
+            case CipherType::SM4:
+                return "cbc(sm4)";
+            default:
+                return nullptr;
+        }
+    }
+
+    // the socket bound to `cipher`'s kernel algorithm, or -1 if AF_ALG or the algorithm is missing
+    int boundSocket(CipherType cipher) const {
+        auto it = sockets_.find(cipher);
+        if (it == sockets_.end()) {
+            Fd fd(::socket(AF_ALG, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+            sockaddr_alg addr{};
+            addr.salg_family = AF_ALG;
+            std::strcpy(reinterpret_cast<char*>(addr.salg_type), "skcipher");
+            const char* name = kernelName(cipher);
+            if (name) {
+                std::strcpy(reinterpret_cast<char*>(addr.salg_name), name);
+            }
+            if (!name || (fd.get() >= 0 && ::bind(fd.get(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)) {
+                fd.reset();
+            }
+            it = sockets_.emplace(cipher, std::move(fd)).first;
+        }
+        return it->second.get();
+    }
+
+    void crypt(CipherType cipher, bool encrypt, const unsigned char* in, size_t length,
+               const unsigned char* last, size_t lastLength, unsigned char* out,
+               const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv) {
+        const int tfm = boundSocket(cipher);
+        if (tfm < 0) {
+            throw std::runtime_error("AF_ALG or the kernel's " + cipherTypeToString(cipher) + "-CBC is unavailable");
+        }
+        const size_t block = cipherBlockSize(cipher);
+        if (iv.size() != block) {
+            throw std::runtime_error("AF_ALG: IV must be one block");
+        }
+        ++syscalls_;
+        if (::setsockopt(tfm, SOL_ALG, ALG_SET_KEY, key.data(), static_cast<socklen_t>(key.size())) != 0) {
+            throw sysError("ALG_SET_KEY");
+        }
+        ++syscalls_;
+        Fd op(::accept4(tfm, nullptr, nullptr, SOCK_CLOEXEC));
+        if (op.get() < 0) {
+            throw sysError("accept");
+        }
+
+        // operation and IV as control data, optionally followed by the whole input
+        alignas(cmsghdr) unsigned char control[CMSG_SPACE(sizeof(uint32_t))
+                                              + CMSG_SPACE(sizeof(af_alg_iv) + EVP_MAX_IV_LENGTH)] = {};
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(af_alg_iv) + block);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_ALG;
+        cmsg->cmsg_type = ALG_SET_OP;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint32_t));
+        const uint32_t opType = encrypt ? ALG_OP_ENCRYPT : ALG_OP_DECRYPT;
+        std::memcpy(CMSG_DATA(cmsg), &opType, sizeof(opType));
+        cmsg = CMSG_NXTHDR(&msg, cmsg);
+        cmsg->cmsg_level = SOL_ALG;
+        cmsg->cmsg_type = ALG_SET_IV;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(af_alg_iv) + block);
+        af_alg_iv algIv{};
+        algIv.ivlen = static_cast<uint32_t>(block);
+        std::memcpy(CMSG_DATA(cmsg), &algIv, sizeof(algIv));
+        std::memcpy(CMSG_DATA(cmsg) + sizeof(af_alg_iv), iv.data(), block);
+
+        const size_t total = length + lastLength;
+        if (total < kSpliceThreshold) {
+            iovec iov[2] = {{const_cast<unsigned char*>(in), length}, {const_cast<unsigned char*>(last), lastLength}};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = lastLength ? 2 : 1;
+            sendAll(op.get(), msg, total, 0);
+            readAll(op.get(), out, total);
+            return;
+        }
+
+        sendAll(op.get(), msg, 0, MSG_MORE);
+        for (size_t done = 0; done < length;) {
+            const size_t n = std::min(kChunkSize, length - done);
+            spliceChunk(op.get(), in + done, n, done + n < length || lastLength > 0);
+            readAll(op.get(), out + done, n);
+            done += n;
+        }
+        if (lastLength > 0) {
+            iovec iov = {const_cast<unsigned char*>(last), lastLength};
+            msghdr tail{};
+            tail.msg_iov = &iov;
+            tail.msg_iovlen = 1;
+            sendAll(op.get(), tail, lastLength, 0);
+            readAll(op.get(), out + length, lastLength);
+        }
+    }
+
+    // sendmsg until `length` bytes of msg's iovecs are sent (control data goes with the first call)
+    void sendAll(int fd, msghdr& msg, size_t length, int flags) {
+        size_t sent = 0;
+        do {
+            ++syscalls_;
+            const ssize_t n = ::sendmsg(fd, &msg, flags);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw sysError("sendmsg");
+            }
+            sent += static_cast<size_t>(n);
+            msg.msg_control = nullptr;
+            msg.msg_controllen = 0;
+            for (size_t skip = static_cast<size_t>(n); skip > 0 && msg.msg_iovlen > 0;) {
+                const size_t step = std::min(skip, msg.msg_iov->iov_len);
+                msg.msg_iov->iov_base = static_cast<unsigned char*>(msg.msg_iov->iov_base) + step;
+                msg.msg_iov->iov_len -= step;
+                skip -= step;
+                if (msg.msg_iov->iov_len == 0) {
+                    ++msg.msg_iov;
+                    --msg.msg_iovlen;
+                }
+            }
+        } while (sent < length);
+    }
+
+    void readAll(int fd, unsigned char* out, size_t length) {
+        for (size_t got = 0; got < length;) {
+            ++syscalls_;
+            const ssize_t n = ::read(fd, out + got, length - got);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                throw sysError("read");
+            }
+            got += static_cast<size_t>(n);
+        }
+    }
+
+    // map the caller's pages into the pipe and move them on to the operation socket
+    void spliceChunk(int fd, const unsigned char* in, size_t length, bool more) {
+        if (pipe_[0].get() < 0) {
+            int fds[2];
+            if (::pipe2(fds, O_CLOEXEC) != 0) {
+                throw sysError("pipe");
+            }
+            pipe_[0] = Fd(fds[0]);
+            pipe_[1] = Fd(fds[1]);
+        }
+        try {
+            for (size_t done = 0; done < length;) {
+                iovec iov = {const_cast<unsigned char*>(in + done), length - done};
+                ++syscalls_;
+                const ssize_t mapped = ::vmsplice(pipe_[1].get(), &iov, 1, 0);
+                if (mapped <= 0) {
+                    throw sysError("vmsplice");
+                }
+                const bool lastPiece = done + static_cast<size_t>(mapped) == length;
+                for (ssize_t moved = 0; moved < mapped;) {
+                    ++syscalls_;
+                    const ssize_t n = ::splice(pipe_[0].get(), nullptr, fd, nullptr, static_cast<size_t>(mapped - moved),
+                                               (more || !lastPiece) ? SPLICE_F_MORE : 0);
+                    if (n <= 0) {
+                        throw sysError("splice");
+                    }
+                    moved += n;
+                }
+                done += static_cast<size_t>(mapped);
+            }
+        } catch (...) {
+            // the pipe may still hold pages of this call; start the next one with a fresh pipe
+            pipe_[0].reset();
+            pipe_[1].reset();
+            throw;
+        }
+    }
+
+    mutable std::map<CipherType, Fd> sockets_;
+    Fd pipe_[2];
+    uint64_t syscalls_ = 0;
+};
+}
+
+std::unique_ptr<CryptoBackend> makeBackend(BackendType backend) {
+    switch (backend) {
+        case BackendType::EVP:
+            return std::make_unique<EvpBackend>();
+        case BackendType::EVP_CIPHER:
+            return std::make_unique<EvpCipherBackend>();
+        case BackendType::LOWLEVEL:
+            return std::make_unique<LowLevelBackend>();
+        case BackendType::INTREE:
+            return std::make_unique<InTreeBackend>();
+        case BackendType::AFALG:
+            return std::make_unique<AfAlgBackend>();
+        default:
+            throw std::invalid_argument("Unknown backend");
+    }
+}
@@ -1,4 +1,5 @@
 #include "crypto_utils.hpp"
+#include "cipher_cache.hpp"
 
 #include <openssl/rand.h>
 #include <openssl/evp.h>
@@ -7,6 +8,16 @@
 #include <stdexcept> // for exceptions
 #include <cstring> // for memcpy if needed
 #include <chrono>
+#include <cctype>
+#include <cstdint>
+
+bool operator==(ByteSpan a, ByteSpan b) {
+    return a.size() == b.size() && (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+bool operator!=(ByteSpan a, ByteSpan b) {
+    return !(a == b);
+}
 
 std::string cipherTypeToString(CipherType cipher) {
     switch(cipher) {
@@ -21,18 +32,37 @@ std::string cipherTypeToString(CipherType cipher) {
     }
 }
 
+CipherType cipherTypeFromString(const std::string& name) {
+    std::string upper;
+    for (char c : name) {
+        upper += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    for (CipherType cipher : {CipherType::AES, CipherType::CAMELLIA, CipherType::SM4}) {
+        if (cipherTypeToString(cipher) == upper) {
+            return cipher;
+        }
+    }
+    throw std::invalid_argument("Unknown cipher: " + name);
+}
+
 namespace {
+// explicitly fetched cipher (see cipher_cache.hpp), memoised per thread so the hot path takes no lock
 const EVP_CIPHER* resolve_cipher(CipherType cipher) {
-    switch (cipher) {
-        case CipherType::AES:
-            return EVP_aes_128_cbc();
-        case CipherType::CAMELLIA:
-            return EVP_camellia_128_cbc();
-        case CipherType::SM4:
-            return EVP_sm4_cbc();
-        default:
-            return nullptr;
+    thread_local const EVP_CIPHER* memo[3] = {};
+    thread_local uint64_t memoGeneration = 0;
+    const size_t index = static_cast<size_t>(cipher);
+    if (index >= 3) {
+        return nullptr;
+    }
+    const uint64_t generation = cipherCacheGeneration();
+    if (memoGeneration != generation) {
+        memo[0] = memo[1] = memo[2] = nullptr;
+        memoGeneration = generation;
     }
+    if (!memo[index]) {
+        memo[index] = fetchCipher(evpCipherName(cipher));
+    }
+    return memo[index];
 }
 }
 
@@ -48,9 +78,9 @@ std::vector<unsigned char> generateRandomBytes(size_t size) {
 
 
 // encrypt data using specified cipher in CBC mode
-std::vector<unsigned char> encrypt(
+ByteBuffer encrypt(
     CipherType cipher,
-    const std::vector<unsigned char>& plaintext,
+    ByteSpan plaintext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 ) {
@@ -70,8 +100,8 @@ std::vector<unsigned char> encrypt(
         EVP_CIPHER_CTX_free(ctx);
         throw std::runtime_error("EVP_EncryptInit_ex failed");
     }
-    // allocate buffer for ciphertext (plaintext size + block size for padding)
-    std::vector<unsigned char> ciphertext(plaintext.size() + EVP_CIPHER_block_size(evp_cipher));
+    // allocate buffer for ciphertext (plaintext size + block size for padding), left uninitialised
+    ByteBuffer ciphertext(plaintext.size() + EVP_CIPHER_block_size(evp_cipher));
     int len = 0;
     int ciphertext_len = 0;
 
@@ -97,9 +127,9 @@ std::vector<unsigned char> encrypt(
 }
 
 // implement the decrypt function, using the specified cipher in CBC mode
-std::vector<unsigned char> decrypt(
+ByteBuffer decrypt(
     CipherType cipher,
-    const std::vector<unsigned char>& ciphertext,
+    ByteSpan ciphertext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 )
@@ -123,7 +153,7 @@ std::vector<unsigned char> decrypt(
     }
 
     // allocate buffer for plaintext (ciphertext size, as decrypted data will be <= ciphertext size structurally)
-    std::vector<unsigned char> plaintext(ciphertext.size());
+    ByteBuffer plaintext(ciphertext.size());
     int len = 0;
     int plaintext_len = 0;
 
@@ -149,9 +179,9 @@ std::vector<unsigned char> decrypt(
 }
 
 // Timed encryption: measure only EVP init/update/final using steady_clock
-std::pair<std::vector<unsigned char>, double> encrypt_with_timing(
+std::pair<ByteBuffer, double> encrypt_with_timing(
     CipherType cipher,
-    const std::vector<unsigned char>& plaintext,
+    ByteSpan plaintext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 ) {
@@ -171,7 +201,7 @@ std::pair<std::vector<unsigned char>, double> encrypt_with_timing(
         EVP_CIPHER_CTX_free(ctx);
         throw std::runtime_error("EVP_EncryptInit_ex failed");
     }
-    std::vector<unsigned char> ciphertext(plaintext.size() + EVP_CIPHER_block_size(evp_cipher));
+    ByteBuffer ciphertext(plaintext.size() + EVP_CIPHER_block_size(evp_cipher));
     int len = 0;
     int ciphertext_len = 0;
     if (EVP_EncryptUpdate(ctx, ciphertext.data(), &len, plaintext.data(), static_cast<int>(plaintext.size())) != 1) {
@@ -190,13 +220,13 @@ std::pair<std::vector<unsigned char>, double> encrypt_with_timing(
     ciphertext.resize(ciphertext_len);
 
     std::chrono::duration<double, std::milli> dt = t1 - t0;
-    return {ciphertext, dt.count()};
+    return {std::move(ciphertext), dt.count()};
 }
 
 // Timed decryption: measure only EVP init/update/final using steady_clock
-std::pair<std::vector<unsigned char>, double> decrypt_with_timing(
+std::pair<ByteBuffer, double> decrypt_with_timing(
     CipherType cipher,
-    const std::vector<unsigned char>& ciphertext,
+    ByteSpan ciphertext,
     const std::vector<unsigned char>& key,
     const std::vector<unsigned char>& iv
 ) {
@@ -216,7 +246,7 @@ std::pair<std::vector<unsigned char>, double> decrypt_with_timing(
         EVP_CIPHER_CTX_free(ctx);
         throw std::runtime_error("EVP_DecryptInit_ex failed");
     }
-    std::vector<unsigned char> plaintext(ciphertext.size());
+    ByteBuffer plaintext(ciphertext.size());
     int len = 0;
     int plaintext_len = 0;
     if (EVP_DecryptUpdate(ctx, plaintext.data(), &len, ciphertext.data(), static_cast<int>(ciphertext.size())) != 1) {
@@ -235,5 +265,512 @@ std::pair<std::vector<unsigned char>, double> decrypt_with_timing(
     plaintext.resize(plaintext_len);
 
     std::chrono::duration<double, std::milli> dt = t1 - t0;
-    return {plaintext, dt.count()};
+    return {std::move(plaintext), dt.count()};
+}
+
+size_t cipherBlockSize(CipherType cipher) {
+    const EVP_CIPHER* evp_cipher = resolve_cipher(cipher);
+    if (!evp_cipher) {
+        throw std::runtime_error("Unsupported cipher type");
+    }
+    return static_cast<size_t>(EVP_CIPHER_block_size(evp_cipher));
+}
+
+namespace {
+// timed init/update/final of `evp_cipher` from `in` into caller-provided `out`
+std::pair<size_t, double> evp_into_with_timing(
+    const EVP_CIPHER* evp_cipher,
+    bool encrypt,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    using clock = std::chrono::steady_clock;
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) {
+        throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+    }
+
+    auto t0 = clock::now();
+    if (EVP_CipherInit_ex(ctx, evp_cipher, nullptr, key.data(), iv.data(), encrypt ? 1 : 0) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error(encrypt ? "EVP_EncryptInit_ex failed" : "EVP_DecryptInit_ex failed");
+    }
+    int len = 0;
+    int out_len = 0;
+    if (EVP_CipherUpdate(ctx, out, &len, in, static_cast<int>(length)) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error(encrypt ? "EVP_EncryptUpdate failed" : "EVP_DecryptUpdate failed");
+    }
+    out_len = len;
+    if (EVP_CipherFinal_ex(ctx, out + len, &len) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error(encrypt ? "EVP_EncryptFinal_ex failed"
+                                         : "EVP_DecryptFinal_ex failed: failed to finalize decryption");
+    }
+    out_len += len;
+    auto t1 = clock::now();
+
+    EVP_CIPHER_CTX_free(ctx);
+
+    std::chrono::duration<double, std::milli> dt = t1 - t0;
+    return {static_cast<size_t>(out_len), dt.count()};
+}
+
+const EVP_CIPHER* resolve_cipher_name(const std::string& name) {
+    return fetchCipher(name);
+}
+
+}
+
+const EVP_CIPHER* evpCipher(CipherType cipher) {
+    const EVP_CIPHER* evp_cipher = resolve_cipher(cipher);
+    if (!evp_cipher) {
+        throw std::runtime_error("Unsupported cipher type");
+    }
+    return evp_cipher;
+}
+
+// Timed encryption into a caller-provided buffer: no allocation inside the measured region
+std::pair<size_t, double> encrypt_into_with_timing(
+    CipherType cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return evp_into_with_timing(evpCipher(cipher), true, in, length, out, key, iv);
+}
+
+// Timed decryption into a caller-provided buffer: no allocation inside the measured region
+std::pair<size_t, double> decrypt_into_with_timing(
+    CipherType cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return evp_into_with_timing(evpCipher(cipher), false, in, length, out, key, iv);
+}
+
+std::pair<size_t, double> evp_encrypt_into_with_timing(
+    const std::string& cipherName,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return evp_into_with_timing(resolve_cipher_name(cipherName), true, in, length, out, key, iv);
+}
+
+std::pair<size_t, double> evp_decrypt_into_with_timing(
+    const std::string& cipherName,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return evp_into_with_timing(resolve_cipher_name(cipherName), false, in, length, out, key, iv);
+}
+
+std::pair<size_t, double> evp_encrypt_into_with_timing(
+    const evp_cipher_st* cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return evp_into_with_timing(cipher, true, in, length, out, key, iv);
+}
+
+std::pair<size_t, double> evp_decrypt_into_with_timing(
+    const evp_cipher_st* cipher,
+    const unsigned char* in,
+    size_t length,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return evp_into_with_timing(cipher, false, in, length, out, key, iv);
+}
+
+size_t paddedLength(CipherType cipher, size_t length) {
+    const size_t block = cipherBlockSize(cipher);
+    return (length / block + 1) * block;
+}
+
+namespace {
+// one init/update/final pass with out == in; returns pair<outputLength, timeMs>
+std::pair<size_t, double> cipher_in_place(
+    CipherType cipher,
+    bool encrypt,
+    unsigned char* data,
+    size_t length,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    using clock = std::chrono::steady_clock;
+    const EVP_CIPHER* evp_cipher = resolve_cipher(cipher);
+    if (!evp_cipher) {
+        throw std::runtime_error("Unsupported cipher type");
+    }
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) {
+        throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+    }
+
+    auto t0 = clock::now();
+    if (EVP_CipherInit_ex(ctx, evp_cipher, nullptr, key.data(), iv.data(), encrypt ? 1 : 0) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error(encrypt ? "EVP_EncryptInit_ex failed" : "EVP_DecryptInit_ex failed");
+    }
+    int len = 0;
+    int out_len = 0;
+    // update never writes past the input: it emits whole blocks only, and while decrypting it
+    // holds back the last block for padding removal
+    if (EVP_CipherUpdate(ctx, data, &len, data, static_cast<int>(length)) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error(encrypt ? "EVP_EncryptUpdate failed" : "EVP_DecryptUpdate failed");
+    }
+    out_len = len;
+    // final writes the padded block (encrypt) or the unpadded tail (decrypt) right after it
+    if (EVP_CipherFinal_ex(ctx, data + len, &len) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error(encrypt ? "EVP_EncryptFinal_ex failed"
+                                         : "EVP_DecryptFinal_ex failed: failed to finalize decryption");
+    }
+    out_len += len;
+    auto t1 = clock::now();
+
+    EVP_CIPHER_CTX_free(ctx);
+
+    std::chrono::duration<double, std::milli> dt = t1 - t0;
+    return {static_cast<size_t>(out_len), dt.count()};
+}
+}
+
+void encrypt_in_place(
+    CipherType cipher,
+    ByteBuffer& data,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    const size_t length = data.size();
+    // make room for the padding first; ByteBuffer does not zero the new bytes
+    data.resize(paddedLength(cipher, length));
+    data.resize(cipher_in_place(cipher, true, data.data(), length, key, iv).first);
+}
+
+void decrypt_in_place(
+    CipherType cipher,
+    ByteBuffer& data,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    data.resize(cipher_in_place(cipher, false, data.data(), data.size(), key, iv).first);
+}
+
+std::pair<size_t, double> encrypt_in_place_with_timing(
+    CipherType cipher,
+    unsigned char* data,
+    size_t length,
+    size_t capacity,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    if (capacity < paddedLength(cipher, length)) {
+        throw std::runtime_error("In-place encryption needs room for the padding block");
+    }
+    return cipher_in_place(cipher, true, data, length, key, iv);
+}
+
+std::pair<size_t, double> decrypt_in_place_with_timing(
+    CipherType cipher,
+    unsigned char* data,
+    size_t length,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return cipher_in_place(cipher, false, data, length, key, iv);
+}
+
+namespace {
+void cipher_batch(
+    CipherType cipher,
+    bool encrypt,
+    std::vector<BatchItem>& items,
+    const std::vector<unsigned char>& key
+) {
+    // key schedule once for the whole batch
+    CipherSession session(cipher, encrypt, key);
+    for (BatchItem& item : items) {
+        item.outLength = session.process(item.input, item.iv, item.out);
+    }
+}
+}
+
+void encrypt_batch(
+    CipherType cipher,
+    std::vector<BatchItem>& items,
+    const std::vector<unsigned char>& key
+) {
+    cipher_batch(cipher, true, items, key);
+}
+
+void decrypt_batch(
+    CipherType cipher,
+    std::vector<BatchItem>& items,
+    const std::vector<unsigned char>& key
+) {
+    cipher_batch(cipher, false, items, key);
+}
+
+CipherStream::CipherStream(
+    CipherType cipher,
+    bool encrypt,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) : encrypt_(encrypt) {
+    const EVP_CIPHER* evp_cipher = resolve_cipher(cipher);
+    if (!evp_cipher) {
+        throw std::runtime_error("Unsupported cipher type");
+    }
+    ctx_ = EVP_CIPHER_CTX_new();
+    if (!ctx_) {
+        throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+    }
+    if (EVP_CipherInit_ex(ctx_, evp_cipher, nullptr, key.data(), iv.data(), encrypt ? 1 : 0) != 1) {
+        EVP_CIPHER_CTX_free(ctx_);
+        ctx_ = nullptr;
+        throw std::runtime_error("EVP_CipherInit_ex failed");
+    }
+}
+
+CipherStream::~CipherStream() {
+    EVP_CIPHER_CTX_free(ctx_);
+}
+
+CipherStream::CipherStream(CipherStream&& other) noexcept
+    : ctx_(other.ctx_), encrypt_(other.encrypt_) {
+    other.ctx_ = nullptr;
+}
+
+CipherStream& CipherStream::operator=(CipherStream&& other) noexcept {
+    if (this != &other) {
+        EVP_CIPHER_CTX_free(ctx_);
+        ctx_ = other.ctx_;
+        encrypt_ = other.encrypt_;
+        other.ctx_ = nullptr;
+    }
+    return *this;
+}
+
+size_t CipherStream::update(ByteSpan in, unsigned char* out) {
+    int len = 0;
+    if (EVP_CipherUpdate(ctx_, out, &len, in.data(), static_cast<int>(in.size())) != 1) {
+        throw std::runtime_error(encrypt_ ? "EVP_EncryptUpdate failed" : "EVP_DecryptUpdate failed");
+    }
+    return static_cast<size_t>(len);
+}
+
+size_t CipherStream::finish(unsigned char* out) {
+    int len = 0;
+    if (EVP_CipherFinal_ex(ctx_, out, &len) != 1) {
+        throw std::runtime_error(encrypt_ ? "EVP_EncryptFinal_ex failed"
+                                          : "EVP_DecryptFinal_ex failed: failed to finalize decryption");
+    }
+    return static_cast<size_t>(len);
+}
+
+CipherSession::CipherSession(
+    CipherType cipher,
+    bool encrypt,
+    const std::vector<unsigned char>& key
+) : encrypt_(encrypt) {
+    const EVP_CIPHER* evp_cipher = resolve_cipher(cipher);
+    if (!evp_cipher) {
+        throw std::runtime_error("Unsupported cipher type");
+    }
+    ctx_ = EVP_CIPHER_CTX_new();
+    if (!ctx_) {
+        throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+    }
+    if (EVP_CipherInit_ex(ctx_, evp_cipher, nullptr, key.data(), nullptr, encrypt ? 1 : 0) != 1) {
+        EVP_CIPHER_CTX_free(ctx_);
+        ctx_ = nullptr;
+        throw std::runtime_error(encrypt ? "EVP_EncryptInit_ex failed" : "EVP_DecryptInit_ex failed");
+    }
+}
+
+CipherSession::~CipherSession() {
+    EVP_CIPHER_CTX_free(ctx_);
+}
+
+CipherSession::CipherSession(CipherSession&& other) noexcept
+    : ctx_(other.ctx_), encrypt_(other.encrypt_) {
+    other.ctx_ = nullptr;
+}
+
+CipherSession& CipherSession::operator=(CipherSession&& other) noexcept {
+    if (this != &other) {
+        EVP_CIPHER_CTX_free(ctx_);
+        ctx_ = other.ctx_;
+        encrypt_ = other.encrypt_;
+        other.ctx_ = nullptr;
+    }
+    return *this;
+}
+
+size_t CipherSession::process(ByteSpan in, const unsigned char* iv, unsigned char* out) {
+    // new IV only: keeps the expanded key and resets the buffered partial block
+    if (EVP_CipherInit_ex(ctx_, nullptr, nullptr, nullptr, iv, -1) != 1) {
+        throw std::runtime_error("EVP_CipherInit_ex (IV reset) failed");
+    }
+    int len = 0;
+    if (EVP_CipherUpdate(ctx_, out, &len, in.data(), static_cast<int>(in.size())) != 1) {
+        throw std::runtime_error(encrypt_ ? "EVP_EncryptUpdate failed" : "EVP_DecryptUpdate failed");
+    }
+    int final_len = 0;
+    if (EVP_CipherFinal_ex(ctx_, out + len, &final_len) != 1) {
+        throw std::runtime_error(encrypt_ ? "EVP_EncryptFinal_ex failed"
+                                          : "EVP_DecryptFinal_ex failed: failed to finalize decryption");
+    }
+    return static_cast<size_t>(len + final_len);
+}
+
+std::pair<size_t, double> CipherSession::process_with_timing(ByteSpan in, const unsigned char* iv, unsigned char* out) {
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    const size_t written = process(in, iv, out);
+    auto t1 = clock::now();
+    std::chrono::duration<double, std::milli> dt = t1 - t0;
+    return {written, dt.count()};
+}
+
+namespace {
+size_t cipher_gather(
+    CipherType cipher,
+    bool encrypt,
+    const std::vector<ByteSpan>& fragments,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    CipherStream stream(cipher, encrypt, key, iv);
+    size_t written = 0;
+    for (ByteSpan fragment : fragments) {
+        written += stream.update(fragment, out + written);
+    }
+    return written + stream.finish(out + written);
+}
+
+size_t total_length(const std::vector<ByteSpan>& fragments) {
+    size_t total = 0;
+    for (ByteSpan fragment : fragments) {
+        total += fragment.size();
+    }
+    return total;
+}
+}
+
+size_t encrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return cipher_gather(cipher, true, fragments, out, key, iv);
+}
+
+size_t decrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    unsigned char* out,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    return cipher_gather(cipher, false, fragments, out, key, iv);
+}
+
+ByteBuffer encrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    ByteBuffer out(total_length(fragments) + cipherBlockSize(cipher));
+    out.resize(cipher_gather(cipher, true, fragments, out.data(), key, iv));
+    return out;
+}
+
+ByteBuffer decrypt_gather(
+    CipherType cipher,
+    const std::vector<ByteSpan>& fragments,
+    const std::vector<unsigned char>& key,
+    const std::vector<unsigned char>& iv
+) {
+    ByteBuffer out(total_length(fragments) + cipherBlockSize(cipher));
+    out.resize(cipher_gather(cipher, false, fragments, out.data(), key, iv));
+    return out;
+}
+
+StreamDigest::StreamDigest(const std::string& name) {
+    const EVP_MD* md = EVP_get_digestbyname(name.c_str());
+    if (!md) {
+        throw std::runtime_error("Unknown digest: " + name);
+    }
+    ctx_ = EVP_MD_CTX_new();
+    if (!ctx_) {
+        throw std::runtime_error("Failed to create EVP_MD_CTX");
+    }
+    if (EVP_DigestInit_ex(ctx_, md, nullptr) != 1) {
+        EVP_MD_CTX_free(ctx_);
+        throw std::runtime_error("EVP_DigestInit_ex failed");
+    }
+}
+
+StreamDigest::~StreamDigest() {
+    EVP_MD_CTX_free(ctx_);
+}
+
+void StreamDigest::update(ByteSpan data) {
+    if (EVP_DigestUpdate(ctx_, data.data(), data.size()) != 1) {
+        throw std::runtime_error("EVP_DigestUpdate failed");
+    }
+}
+
+std::vector<unsigned char> StreamDigest::finish() {
+    std::vector<unsigned char> digest(EVP_MAX_MD_SIZE);
+    unsigned int len = 0;
+    if (EVP_DigestFinal_ex(ctx_, digest.data(), &len) != 1) {
+        throw std::runtime_error("EVP_DigestFinal_ex failed");
+    }
+    digest.resize(len);
+    return digest;
+}
+
+std::vector<unsigned char> digestBytes(ByteSpan data, const std::string& name) {
+    StreamDigest digest(name);
+    digest.update(data);
+    return digest.finish();
+}
+
+std::string toHex(ByteSpan bytes) {
+    static const char* digits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (unsigned char b : bytes) {
+        hex += digits[b >> 4];
+        hex += digits[b & 0x0f];
+    }
+    return hex;
 }
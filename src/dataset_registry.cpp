@@ -0,0 +1,70 @@
+#include "dataset_registry.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+ByteSpan DatasetRegistry::load(const std::string& path) {
+    auto it = datasets_.find(path);
+    if (it != datasets_.end()) {
+        return {it->second.data(), it->second.size()};
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    struct stat sb{};
+    if (::fstat(fd, &sb) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + path);
+    }
+
+    AlignedBuffer buffer(static_cast<size_t>(sb.st_size));
+    size_t done = 0;
+    while (done < buffer.size()) {
+        ssize_t n = ::read(fd, buffer.data() + done, buffer.size() - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to read file: " + path);
+        }
+        done += static_cast<size_t>(n);
+    }
+    ::close(fd);
+
+    buffer.makeReadOnly();
+    auto& stored = datasets_[path] = std::move(buffer);
+    return {stored.data(), stored.size()};
+}
+
+ByteSpan DatasetRegistry::generate(const std::string& name, size_t size,
+                                   const std::function<void(unsigned char*, size_t)>& fill) {
+    auto it = datasets_.find(name);
+    if (it != datasets_.end()) {
+        if (it->second.size() != size) {
+            throw std::runtime_error("Dataset " + name + " already registered with a different size");
+        }
+        return {it->second.data(), it->second.size()};
+    }
+
+    AlignedBuffer buffer(size);
+    fill(buffer.data(), size);
+    buffer.makeReadOnly();
+    auto& stored = datasets_[name] = std::move(buffer);
+    return {stored.data(), stored.size()};
+}
+
+size_t DatasetRegistry::totalBytes() const {
+    size_t total = 0;
+    for (const auto& [name, buffer] : datasets_) {
+        total += buffer.size();
+    }
+    return total;
+}
@@ -0,0 +1,87 @@
+#include "key_cache.hpp"
+
+#include <openssl/evp.h>
+
+#include <chrono>
+#include <stdexcept>
+
+KeyedContextCache::KeyedContextCache(CipherType cipher, bool encrypt, size_t capacity)
+    : cipher_(evpCipher(cipher)), encrypt_(encrypt), capacity_(capacity), work_(nullptr) {
+    if (capacity == 0) {
+        throw std::invalid_argument("KeyedContextCache needs a capacity of at least one key");
+    }
+    work_ = EVP_CIPHER_CTX_new();
+    if (!work_) {
+        throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+    }
+    index_.reserve(capacity);
+}
+
+KeyedContextCache::~KeyedContextCache() {
+    for (Entry& entry : lru_) {
+        EVP_CIPHER_CTX_free(entry.keyed);
+    }
+    EVP_CIPHER_CTX_free(work_);
+}
+
+EVP_CIPHER_CTX* KeyedContextCache::lookup(uint64_t keyId, const std::vector<unsigned char>& key) {
+    auto it = index_.find(keyId);
+    if (it != index_.end()) {
+        ++hits_;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->keyed;
+    }
+    ++misses_;
+    EVP_CIPHER_CTX* keyed = nullptr;
+    if (lru_.size() == capacity_) {
+        // re-key the least recently used template rather than freeing it
+        ++evictions_;
+        keyed = lru_.back().keyed;
+        index_.erase(lru_.back().keyId);
+        lru_.pop_back();
+    } else {
+        keyed = EVP_CIPHER_CTX_new();
+        if (!keyed) {
+            throw std::runtime_error("Failed to create EVP_CIPHER_CTX");
+        }
+    }
+    if (EVP_CipherInit_ex(keyed, cipher_, nullptr, key.data(), nullptr, encrypt_ ? 1 : 0) != 1) {
+        EVP_CIPHER_CTX_free(keyed);
+        throw std::runtime_error(encrypt_ ? "EVP_EncryptInit_ex failed" : "EVP_DecryptInit_ex failed");
+    }
+    lru_.push_front({keyId, keyed});
+    index_[keyId] = lru_.begin();
+    return keyed;
+}
+
+size_t KeyedContextCache::process(uint64_t keyId, const std::vector<unsigned char>& key, ByteSpan in,
+                                  const unsigned char* iv, unsigned char* out) {
+    EVP_CIPHER_CTX* keyed = lookup(keyId, key);
+    if (EVP_CIPHER_CTX_copy(work_, keyed) != 1) {
+        throw std::runtime_error("EVP_CIPHER_CTX_copy failed");
+    }
+    if (EVP_CipherInit_ex(work_, nullptr, nullptr, nullptr, iv, -1) != 1) {
+        throw std::runtime_error("EVP_CipherInit_ex (IV reset) failed");
+    }
+    int len = 0;
+    if (EVP_CipherUpdate(work_, out, &len, in.data(), static_cast<int>(in.size())) != 1) {
+        throw std::runtime_error(encrypt_ ? "EVP_EncryptUpdate failed" : "EVP_DecryptUpdate failed");
+    }
+    int final_len = 0;
+    if (EVP_CipherFinal_ex(work_, out + len, &final_len) != 1) {
+        throw std::runtime_error(encrypt_ ? "EVP_EncryptFinal_ex failed"
+                                          : "EVP_DecryptFinal_ex failed: failed to finalize decryption");
+    }
+    return static_cast<size_t>(len + final_len);
+}
+
+std::pair<size_t, double> KeyedContextCache::process_with_timing(uint64_t keyId, const std::vector<unsigned char>& key,
+                                                                 ByteSpan in, const unsigned char* iv,
+                                                                 unsigned char* out) {
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    const size_t written = process(keyId, key, in, iv, out);
+    auto t1 = clock::now();
+    std::chrono::duration<double, std::milli> dt = t1 - t0;
+    return {written, dt.count()};
+}
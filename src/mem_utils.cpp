@@ -0,0 +1,341 @@
+#include "mem_utils.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BENCH_HAVE_CLFLUSH 1
+#endif
+
+namespace {
+// parse sysfs cache sizes such as "48K", "2048K" or "32M"
+size_t parseCacheSize(const std::string& text) {
+    if (text.empty()) {
+        return 0;
+    }
+    size_t value = std::stoul(text);
+    switch (text.back()) {
+        case 'K': return value * 1024;
+        case 'M': return value * 1024 * 1024;
+        case 'G': return value * 1024 * 1024 * 1024;
+        default: return value;
+    }
+}
+
+std::string readSysfsLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    if (in) {
+        std::getline(in, line);
+    }
+    return line;
+}
+
+// expand a sysfs cpu list such as "0-3,8-11" into CPU numbers
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        std::string range = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        pos = comma + 1;
+    }
+    return cpus;
+}
+
+// node mask for mbind: enough bits for any kernel's MAX_NUMNODES
+const unsigned long kMaxNodes = 1024;
+const size_t kBitsPerWord = 8 * sizeof(unsigned long);
+}
+
+std::vector<NumaNode> detectNumaNodes() {
+    std::vector<NumaNode> nodes;
+    if (DIR* dir = ::opendir("/sys/devices/system/node")) {
+        while (dirent* entry = ::readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+                name.find_first_not_of("0123456789", 4) == std::string::npos) {
+                int id = std::stoi(name.substr(4));
+                std::string cpulist = readSysfsLine("/sys/devices/system/node/" + name + "/cpulist");
+                nodes.push_back({id, parseCpuList(cpulist)});
+            }
+        }
+        ::closedir(dir);
+    }
+    if (nodes.empty()) {
+        std::vector<int> cpus;
+        for (long cpu = 0; cpu < ::sysconf(_SC_NPROCESSORS_CONF); ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        nodes.push_back({0, cpus});
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    return nodes;
+}
+
+void bindMemoryToNode(void* data, size_t length, int node) {
+    if (node < 0 || static_cast<unsigned long>(node) >= kMaxNodes) {
+        throw std::runtime_error("Invalid NUMA node: " + std::to_string(node));
+    }
+    unsigned long mask[kMaxNodes / kBitsPerWord] = {};
+    mask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+    // raw syscall so the benchmark does not depend on libnuma
+    if (::syscall(SYS_mbind, data, length, MPOL_BIND, mask, kMaxNodes + 1, MPOL_MF_MOVE | MPOL_MF_STRICT) != 0) {
+        throw std::runtime_error("mbind to NUMA node " + std::to_string(node) + " failed: " + std::strerror(errno));
+    }
+}
+
+int nodeOfAddress(const void* data) {
+    int node = -1;
+    if (::syscall(SYS_get_mempolicy, &node, nullptr, 0, data, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+std::vector<CacheLevel> detectCacheHierarchy() {
+    std::vector<CacheLevel> levels;
+    for (int index = 0;; ++index) {
+        const std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index);
+        std::string level = readSysfsLine(dir + "/level");
+        if (level.empty()) {
+            break;
+        }
+        if (readSysfsLine(dir + "/type") == "Instruction") {
+            continue;
+        }
+        std::string shared = readSysfsLine(dir + "/shared_cpu_list");
+        levels.push_back({std::stoi(level), parseCacheSize(readSysfsLine(dir + "/size")),
+                          shared.empty() ? 1 : static_cast<int>(parseCpuList(shared).size())});
+    }
+    std::sort(levels.begin(), levels.end(),
+              [](const CacheLevel& a, const CacheLevel& b) { return a.level < b.level; });
+    return levels;
+}
+
+void dropFilePageCache(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for page cache drop: " + filename);
+    }
+    // dirty pages are not dropped, so write them back first
+    ::fdatasync(fd);
+    int rc = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+    if (rc != 0) {
+        throw std::runtime_error("posix_fadvise(POSIX_FADV_DONTNEED) failed for: " + filename);
+    }
+}
+
+size_t cacheLineSize() {
+    static const size_t line = [] {
+        std::string text = readSysfsLine("/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size");
+        size_t value = text.empty() ? 0 : std::stoul(text);
+        return value ? value : size_t{64};
+    }();
+    return line;
+}
+
+size_t lastLevelCacheSize() {
+    static const size_t llc = [] {
+        auto levels = detectCacheHierarchy();
+        size_t best = levels.empty() ? 0 : levels.back().sizeBytes;
+        return best ? best : size_t{32} * 1024 * 1024;
+    }();
+    return llc;
+}
+
+void flushCacheLines(const void* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+#ifdef BENCH_HAVE_CLFLUSH
+    const uintptr_t line = cacheLineSize();
+    uintptr_t p = reinterpret_cast<uintptr_t>(data) & ~(line - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(data) + length;
+    for (; p < end; p += line) {
+        _mm_clflush(reinterpret_cast<const void*>(p));
+    }
+    _mm_mfence();
+#else
+    // no user-space flush instruction: push the range out by writing a buffer twice the LLC size
+    (void)data;
+    static std::vector<unsigned char> evict(2 * lastLevelCacheSize());
+    const size_t line = cacheLineSize();
+    for (size_t i = 0; i < evict.size(); i += line) {
+        evict[i]++;
+    }
+#endif
+}
+
+std::string pageSizeToString(PageSize pages) {
+    switch (pages) {
+        case PageSize::BASE:
+            return "base";
+        case PageSize::THP:
+            return "thp";
+        case PageSize::HUGE_2MB:
+            return "2m";
+        case PageSize::HUGE_1GB:
+            return "1g";
+        default:
+            return "unknown";
+    }
+}
+
+AlignedBuffer::AlignedBuffer(size_t size, PageSize pages, int numaNode) : size_(size), pages_(pages) {
+    const size_t hugeAlign = pages == PageSize::HUGE_1GB ? size_t{1} << 30 : size_t{2} << 20;
+    const size_t rounded = size == 0 ? 1 : size;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    size_t length = rounded;
+
+    switch (pages) {
+        case PageSize::BASE:
+            break;
+        case PageSize::THP:
+            // over-allocate so a 2 MiB aligned start can be picked for the huge pages
+            length = ((rounded + hugeAlign - 1) / hugeAlign) * hugeAlign + hugeAlign;
+            break;
+        case PageSize::HUGE_2MB:
+        case PageSize::HUGE_1GB:
+            flags |= MAP_HUGETLB | (pages == PageSize::HUGE_1GB ? MAP_HUGE_1GB : MAP_HUGE_2MB);
+            length = ((rounded + hugeAlign - 1) / hugeAlign) * hugeAlign;
+            break;
+    }
+
+    void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("mmap of " + std::to_string(length) + " bytes with " +
+                                 pageSizeToString(pages) + " pages failed: " + std::strerror(errno) +
+                                 (pages == PageSize::HUGE_2MB || pages == PageSize::HUGE_1GB
+                                      ? " (are huge pages reserved in /sys/kernel/mm/hugepages?)" : ""));
+    }
+    mapping_ = p;
+    mappedBytes_ = length;
+    data_ = static_cast<unsigned char*>(p);
+
+    if (pages == PageSize::THP) {
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(p) + hugeAlign - 1) & ~(hugeAlign - 1);
+        data_ = reinterpret_cast<unsigned char*>(aligned);
+        size_t adviseLen = ((rounded + hugeAlign - 1) / hugeAlign) * hugeAlign;
+        if (::madvise(data_, adviseLen, MADV_HUGEPAGE) != 0) {
+            release();
+            throw std::runtime_error(std::string("madvise(MADV_HUGEPAGE) failed: ") + std::strerror(errno));
+        }
+    }
+
+    if (numaNode >= 0) {
+        try {
+            bindMemoryToNode(mapping_, mappedBytes_, numaNode);
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    // fault every page in now (without a binding, first touch decides NUMA placement)
+    std::memset(data_, 0, rounded);
+}
+
+AlignedBuffer::~AlignedBuffer() {
+    release();
+}
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapping_ = other.mapping_;
+        mappedBytes_ = other.mappedBytes_;
+        data_ = other.data_;
+        size_ = other.size_;
+        pages_ = other.pages_;
+        other.mapping_ = nullptr;
+        other.mappedBytes_ = 0;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void AlignedBuffer::makeReadOnly() {
+    if (mapping_ && ::mprotect(mapping_, mappedBytes_, PROT_READ) != 0) {
+        throw std::runtime_error(std::string("mprotect(PROT_READ) failed: ") + std::strerror(errno));
+    }
+}
+
+void AlignedBuffer::release() {
+    if (mapping_) {
+        ::munmap(mapping_, mappedBytes_);
+        mapping_ = nullptr;
+        data_ = nullptr;
+    }
+}
+
+BufferRing::BufferRing(size_t inputSize, size_t outputSize, size_t totalBytes, const BufferLayout& layout)
+    : inputSize_(inputSize), outputSize_(outputSize), layout_(layout) {
+    const size_t line = cacheLineSize();
+    auto roundUp = [line](size_t n) { return ((n + line - 1) / line) * line; };
+    outputStart_ = roundUp(layout.inputOffset + inputSize);
+    stride_ = outputStart_ + roundUp(layout.outputOffset + outputSize);
+    if (stride_ == 0) {
+        stride_ = line;
+    }
+    slots_ = (totalBytes + stride_ - 1) / stride_;
+    if (slots_ == 0) {
+        slots_ = 1;
+    }
+    arena_ = AlignedBuffer(slots_ * stride_, layout.pageSize, layout.numaNode);
+}
+
+unsigned char* BufferRing::input(size_t slot) {
+    return arena_.data() + (slot % slots_) * stride_ + layout_.inputOffset;
+}
+
+unsigned char* BufferRing::output(size_t slot) {
+    return arena_.data() + (slot % slots_) * stride_ + outputStart_ + layout_.outputOffset;
+}
+
+void BufferRing::fillInputs(const unsigned char* src, size_t length) {
+    if (length > inputSize_) {
+        throw std::runtime_error("BufferRing input is smaller than the data to copy");
+    }
+    for (size_t slot = 0; slot < slots_; ++slot) {
+        std::memcpy(input(slot), src, length);
+    }
+}
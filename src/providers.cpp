@@ -0,0 +1,144 @@
+#include "providers.hpp"
+#include "cipher_cache.hpp"
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/provider.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace {
+// providers loaded into the default library context by applyProviderConfig, kept until exit
+std::vector<OSSL_PROVIDER*>& globalProviders() {
+    static std::vector<OSSL_PROVIDER*> providers;
+    return providers;
+}
+
+std::runtime_error loadError(const std::string& provider) {
+    const unsigned long code = ERR_get_error();
+    char reason[256] = "unknown error";
+    if (code != 0) {
+        ERR_error_string_n(code, reason, sizeof(reason));
+    }
+    ERR_clear_error();
+    return std::runtime_error("Failed to load OpenSSL provider '" + provider + "': " + reason);
+}
+
+// load `config`'s providers and set its query on `libctx` (nullptr: the default context)
+std::vector<OSSL_PROVIDER*> loadInto(OSSL_LIB_CTX* libctx, const ProviderConfig& config) {
+    std::vector<OSSL_PROVIDER*> loaded;
+    for (const auto& name : config.providers) {
+        OSSL_PROVIDER* provider = OSSL_PROVIDER_load(libctx, name.c_str());
+        if (!provider) {
+            for (OSSL_PROVIDER* p : loaded) {
+                OSSL_PROVIDER_unload(p);
+            }
+            throw loadError(name);
+        }
+        loaded.push_back(provider);
+    }
+    if (EVP_set_default_properties(libctx, config.properties.empty() ? nullptr : config.properties.c_str()) != 1) {
+        for (OSSL_PROVIDER* p : loaded) {
+            OSSL_PROVIDER_unload(p);
+        }
+        ERR_clear_error();
+        throw std::runtime_error("Invalid property query: '" + config.properties + "'");
+    }
+    return loaded;
+}
+}
+
+std::vector<ProviderConfig> standardProviderConfigs() {
+    return {
+        {"default", {"default"}, ""},
+        {"fips", {"fips", "base"}, "fips=yes"},
+        {"default+legacy", {"default", "legacy"}, ""},
+    };
+}
+
+std::string describeProviderConfig(const ProviderConfig& config) {
+    std::string providers;
+    for (const auto& name : config.providers) {
+        providers += (providers.empty() ? "" : "+") + name;
+    }
+    if (providers.empty()) {
+        providers = "(OpenSSL default)";
+    }
+    return config.properties.empty() ? providers : providers + " (" + config.properties + ")";
+}
+
+void applyProviderConfig(const ProviderConfig& config) {
+    auto loaded = loadInto(nullptr, config);
+    globalProviders().insert(globalProviders().end(), loaded.begin(), loaded.end());
+    // ciphers fetched under the previous configuration must not be reused
+    clearCipherCache();
+}
+
+ProviderContext::ProviderContext(const ProviderConfig& config) : libctx_(OSSL_LIB_CTX_new()) {
+    if (!libctx_) {
+        throw std::runtime_error("OSSL_LIB_CTX_new failed");
+    }
+    try {
+        providers_ = loadInto(libctx_, config);
+    } catch (...) {
+        OSSL_LIB_CTX_free(libctx_);
+        throw;
+    }
+}
+
+ProviderContext::~ProviderContext() {
+    release();
+}
+
+ProviderContext::ProviderContext(ProviderContext&& other) noexcept
+    : libctx_(other.libctx_), providers_(std::move(other.providers_)), ciphers_(std::move(other.ciphers_)) {
+    other.libctx_ = nullptr;
+    other.providers_.clear();
+    other.ciphers_.clear();
+}
+
+ProviderContext& ProviderContext::operator=(ProviderContext&& other) noexcept {
+    if (this != &other) {
+        release();
+        libctx_ = other.libctx_;
+        providers_ = std::move(other.providers_);
+        ciphers_ = std::move(other.ciphers_);
+        other.libctx_ = nullptr;
+        other.providers_.clear();
+        other.ciphers_.clear();
+    }
+    return *this;
+}
+
+void ProviderContext::release() {
+    for (auto& entry : ciphers_) {
+        EVP_CIPHER_free(entry.second);
+    }
+    ciphers_.clear();
+    for (OSSL_PROVIDER* provider : providers_) {
+        OSSL_PROVIDER_unload(provider);
+    }
+    providers_.clear();
+    OSSL_LIB_CTX_free(libctx_);
+    libctx_ = nullptr;
+}
+
+const evp_cipher_st* ProviderContext::fetch(const std::string& name) {
+    auto it = ciphers_.find(name);
+    if (it != ciphers_.end()) {
+        return it->second;
+    }
+    EVP_CIPHER* cipher = EVP_CIPHER_fetch(libctx_, name.c_str(), nullptr);
+    if (!cipher) {
+        ERR_clear_error();
+        return nullptr;
+    }
+    ciphers_.emplace(name, cipher);
+    return cipher;
+}
+
+std::string ProviderContext::providerOf(const evp_cipher_st* cipher) {
+    const OSSL_PROVIDER* provider = EVP_CIPHER_get0_provider(cipher);
+    return provider ? OSSL_PROVIDER_get0_name(provider) : "unknown";
+}
@@ -0,0 +1,76 @@
+#include "trace.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// fields of a comma separated line, with surrounding blanks trimmed
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        const auto first = field.find_first_not_of(" \t\r");
+        const auto last = field.find_last_not_of(" \t\r");
+        fields.push_back(first == std::string::npos ? "" : field.substr(first, last - first + 1));
+    }
+    return fields;
+}
+
+TraceRecord parseRecord(const std::vector<std::string>& fields) {
+    if (fields.size() < 3 || fields.size() > 5) {
+        throw std::invalid_argument("expected size,cipher,direction[,inter-arrival-us[,key-id]]");
+    }
+    TraceRecord record;
+    size_t used = 0;
+    const unsigned long long size = std::stoull(fields[0], &used);
+    if (used != fields[0].size() || size == 0) {
+        throw std::invalid_argument("bad message size '" + fields[0] + "'");
+    }
+    record.size = static_cast<size_t>(size);
+    record.cipher = cipherTypeFromString(fields[1]);
+    if (fields[2] == "encrypt") {
+        record.encrypt = true;
+    } else if (fields[2] == "decrypt") {
+        record.encrypt = false;
+    } else {
+        throw std::invalid_argument("unknown direction '" + fields[2] + "' (expected encrypt or decrypt)");
+    }
+    if (fields.size() > 3 && !fields[3].empty()) {
+        record.gapUs = std::stod(fields[3], &used);
+        if (used != fields[3].size() || record.gapUs < 0.0) {
+            throw std::invalid_argument("bad inter-arrival time '" + fields[3] + "'");
+        }
+    }
+    if (fields.size() > 4 && !fields[4].empty()) {
+        const unsigned long id = std::stoul(fields[4], &used);
+        if (used != fields[4].size() || id > UINT32_MAX) {
+            throw std::invalid_argument("bad key id '" + fields[4] + "'");
+        }
+        record.keyId = static_cast<uint32_t>(id);
+    }
+    return record;
+}
+}
+
+std::vector<TraceRecord> loadTrace(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open trace file: " + path);
+    }
+    std::vector<TraceRecord> records;
+    std::string line;
+    for (size_t lineNo = 1; std::getline(in, line); ++lineNo) {
+        const auto start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        try {
+            records.push_back(parseRecord(splitFields(line)));
+        } catch (const std::exception& ex) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNo) + ": " + ex.what());
+        }
+    }
+    return records;
+}